@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * 
+ * @param value Tested value, has to be non-zero
+ * @return Index of the lowest set bit
+ */
+inline unsigned int count_trailing_zeros(unsigned long long value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+#if defined(_M_X64) || defined(_M_ARM64)
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    if(_BitScanForward(&index, static_cast<unsigned long>(value)))
+        return index;
+
+    _BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+    return index + 32;
+#endif
+#else
+    return static_cast<unsigned int>(__builtin_ctzll(value));
+#endif
+}
+
+/**
+ * 
+ * @param value Tested value, has to be non-zero
+ * @return Index of the highest set bit (floor of log2)
+ */
+inline unsigned int find_last_set(unsigned long long value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+#if defined(_M_X64) || defined(_M_ARM64)
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+    if(_BitScanReverse(&index, static_cast<unsigned long>(value >> 32)))
+        return index + 32;
+
+    _BitScanReverse(&index, static_cast<unsigned long>(value));
+    return index;
+#endif
+#else
+    return 63 - static_cast<unsigned int>(__builtin_clzll(value));
+#endif
+}
+
+/**
+ * 
+ * @param value Tested value
+ * @return Count of set bits
+ */
+inline unsigned int population_count(unsigned long long value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<unsigned int>(__popcnt64(value));
+#elif defined(_MSC_VER)
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<unsigned int>((value * 0x0101010101010101ULL) >> 56);
+#else
+    return static_cast<unsigned int>(__builtin_popcountll(value));
+#endif
+}
@@ -0,0 +1,290 @@
+﻿#pragma once
+#include <algorithm>
+#include <vector>
+#include "bit_operations.h"
+#include "../Model/pool_size.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BITMAP_ALLOCATOR_SSE2
+#endif
+
+/**
+ * Tracks memory as bitmap of granules, set bit means used granule. Runs of free granules are found with count trailing zeros,
+ * for memory larger than 64 granules fully used / fully free words are skipped using SIMD compares
+ */
+class bitmap_allocator
+{
+public:
+    static const bool supports_compaction = true;
+    static const bool inline_compaction = true;
+
+    // Only state of granules is kept, memory of blocks placed back to back can be claimed at once
+    static const bool tracks_blocks = false;
+
+    bitmap_allocator(pool_size arena_size, pool_size granule_size)
+        : granule_size(granule_size), granule_count(static_cast<unsigned int>(arena_size / granule_size))
+    {
+        reset();
+    }
+
+    /**
+     * Marks whole memory as free
+     */
+    void reset()
+    {
+        // One extra word behind memory stays used, therefore search for used granule always ends
+        words.assign((granule_count + 63) / 64 + 1, 0);
+        set_range(granule_count, static_cast<unsigned int>(words.size() * 64) - granule_count, true);
+    }
+
+    /**
+     * 
+     * @param size Requested size
+     * @return Size of memory block that is allocated for requested size
+     */
+    pool_size round_size(pool_size size) const
+    {
+        return (size + granule_size - 1) / granule_size * granule_size;
+    }
+
+    /**
+     * Looks for the first run of free granules that can fit requested size
+     * @param size Requested size, multiple of granule size
+     * @param offset Offset of found memory
+     * @return true if memory was found, otherwise false
+     */
+    bool find(pool_size size, pool_size& offset) const
+    {
+        unsigned int count = static_cast<unsigned int>(size / granule_size);
+
+        if(words.size() == 2 && count <= 64)
+        {
+            // Whole memory fits one word, bit i of runs stays set only if granules i ... i + count - 1 are free
+            unsigned long long runs = ~words[0];
+            unsigned int run_length = 1;
+
+            while(run_length < count && runs != 0)
+            {
+                unsigned int step = std::min(run_length, count - run_length);
+                runs &= runs >> step;
+                run_length += step;
+            }
+
+            if(runs == 0)
+                return false;
+
+            offset = count_trailing_zeros(runs) * granule_size;
+            return true;
+        }
+
+        unsigned int granule = 0;
+        while(true)
+        {
+            unsigned int run_start = next_granule(granule, false);
+            if(run_start >= granule_count)
+                return false;
+
+            unsigned int run_end = next_granule(run_start, true);
+            if(run_end - run_start >= count)
+            {
+                offset = run_start * granule_size;
+                return true;
+            }
+
+            granule = run_end;
+        }
+    }
+
+    /**
+     * 
+     * @param offset Offset of memory block
+     * @param old_size Current size of memory block
+     * @param new_size Requested size of memory block
+     * @return true if memory block can be resized without moving it, otherwise false
+     */
+    bool can_resize(pool_size offset, pool_size old_size, pool_size new_size) const
+    {
+        if(new_size <= old_size)
+            return true;
+
+        pool_size end = (offset + new_size) / granule_size;
+        if(end > granule_count)
+            return false;
+
+        return next_granule(static_cast<unsigned int>((offset + old_size) / granule_size), true) >= end;
+    }
+
+    /**
+     * 
+     * @param offset Offset of memory block
+     * @return Size of free granules that end right at offset, 0 if granule before offset is used
+     */
+    pool_size gap_before(pool_size offset) const
+    {
+        unsigned int granule = static_cast<unsigned int>(offset / granule_size);
+        unsigned int start = granule;
+
+        // Words are searched backwards for the last used granule before offset
+        while(start > 0)
+        {
+            unsigned int bit = (start - 1) % 64;
+            unsigned long long used = words[(start - 1) / 64] & (bit == 63 ? ~0ULL : (1ULL << (bit + 1)) - 1);
+
+            if(used != 0)
+            {
+                start = (start - 1) / 64 * 64 + find_last_set(used) + 1;
+                break;
+            }
+
+            start = (start - 1) / 64 * 64;
+        }
+
+        return (granule - start) * granule_size;
+    }
+
+    /**
+     * Marks memory as used, offset has to be start of free memory
+     * @param offset Offset of used memory
+     * @param size Size of used memory
+     */
+    void claim(pool_size offset, pool_size size)
+    {
+        set_range(static_cast<unsigned int>(offset / granule_size), static_cast<unsigned int>(size / granule_size), true);
+    }
+
+    /**
+     * Marks memory block as free
+     * @param offset Offset of released memory block
+     * @param size Size of released memory block
+     */
+    void release(pool_size offset, pool_size size)
+    {
+        set_range(static_cast<unsigned int>(offset / granule_size), static_cast<unsigned int>(size / granule_size), false);
+    }
+
+    /**
+     * Resizes memory block without moving it, can_resize has to be checked first
+     * @param offset Offset of memory block
+     * @param old_size Current size of memory block
+     * @param new_size New size of memory block
+     */
+    void resize(pool_size offset, pool_size old_size, pool_size new_size)
+    {
+        if(new_size > old_size)
+            claim(offset + old_size, new_size - old_size);
+        else
+            release(offset + new_size, old_size - new_size);
+    }
+
+    /**
+     * 
+     * @return Size of the largest run of free granules, 0 if memory is full
+     */
+    pool_size largest_gap() const
+    {
+        unsigned int largest = 0;
+        unsigned int granule = next_granule(0, false);
+
+        while(granule < granule_count)
+        {
+            unsigned int run_end = next_granule(granule, true);
+            largest = std::max(largest, run_end - granule);
+            granule = next_granule(run_end, false);
+        }
+
+        return largest * granule_size;
+    }
+
+private:
+    pool_size granule_size;
+    unsigned int granule_count;
+    std::vector<unsigned long long> words;
+
+    /**
+     * 
+     * @param granule First tested granule
+     * @param used Searched state of granule
+     * @return Index of the first granule from given one with requested state, granule count of padded bitmap if there is none
+     */
+    unsigned int next_granule(unsigned int granule, bool used) const
+    {
+        size_t word = granule / 64;
+        if(word >= words.size())
+            return static_cast<unsigned int>(words.size() * 64);
+
+        // Bits of used granules are set, free granules are searched in negated word
+        unsigned long long bits = (used ? words[word] : ~words[word]) & (~0ULL << (granule % 64));
+        if(bits != 0)
+            return static_cast<unsigned int>(word * 64) + count_trailing_zeros(bits);
+
+        // Words without any granule of requested state are skipped
+        word = find_word_not_equal(word + 1, used ? 0ULL : ~0ULL);
+        if(word >= words.size())
+            return static_cast<unsigned int>(words.size() * 64);
+
+        bits = used ? words[word] : ~words[word];
+        return static_cast<unsigned int>(word * 64) + count_trailing_zeros(bits);
+    }
+
+    /**
+     * 
+     * @param word First tested word
+     * @param pattern Skipped word value, either 0 or all bits set
+     * @return Index of the first word from given one that differs from pattern, word count if there is none
+     */
+    size_t find_word_not_equal(size_t word, unsigned long long pattern) const
+    {
+#if defined(__AVX2__)
+        __m256i target = _mm256_set1_epi32(static_cast<int>(pattern));
+        for(; word + 4 <= words.size(); word += 4)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&words[word]));
+            if(_mm256_movemask_epi8(_mm256_cmpeq_epi32(block, target)) != -1)
+                break;
+        }
+#elif defined(BITMAP_ALLOCATOR_SSE2)
+        __m128i target = _mm_set1_epi32(static_cast<int>(pattern));
+        for(; word + 2 <= words.size(); word += 2)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&words[word]));
+            if(_mm_movemask_epi8(_mm_cmpeq_epi32(block, target)) != 0xFFFF)
+                break;
+        }
+#endif
+
+        for(; word < words.size(); word++)
+        {
+            if(words[word] != pattern)
+                return word;
+        }
+
+        return words.size();
+    }
+
+    /**
+     * Sets state of consecutive granules
+     * @param granule First granule
+     * @param count Count of granules
+     * @param used New state of granules
+     */
+    void set_range(unsigned int granule, unsigned int count, bool used)
+    {
+        while(count > 0)
+        {
+            unsigned int bit = granule % 64;
+            unsigned int span = std::min(count, 64 - bit);
+            unsigned long long mask = (span == 64 ? ~0ULL : (1ULL << span) - 1) << bit;
+
+            if(used)
+                words[granule / 64] |= mask;
+            else
+                words[granule / 64] &= ~mask;
+
+            granule += span;
+            count -= span;
+        }
+    }
+};
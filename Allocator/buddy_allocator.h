@@ -0,0 +1,258 @@
+﻿#pragma once
+#include <vector>
+#include "bit_operations.h"
+#include "../Model/pool_size.h"
+
+/**
+ * Power of two buddy allocator. Memory blocks are granule * 2^order bytes large and aligned to their size,
+ * free blocks of each order are kept in a list and bitmask of non-empty lists finds fitting block in O(1).
+ * Split and merge of blocks is done in O(log n)
+ */
+class buddy_allocator
+{
+public:
+    // Blocks have to stay aligned to their size, therefore they can't be bunched together
+    static const bool supports_compaction = false;
+    static const bool inline_compaction = false;
+    static const bool tracks_blocks = true;
+
+    buddy_allocator(pool_size arena_size, pool_size granule_size)
+        : granule_size(granule_size), granule_count(static_cast<unsigned int>(arena_size / granule_size))
+    {
+        reset();
+    }
+
+    /**
+     * Marks whole memory as free
+     */
+    void reset()
+    {
+        free_order.assign(granule_count, -1);
+        next_free.assign(granule_count, NONE);
+        previous_free.assign(granule_count, NONE);
+        order_mask = 0;
+
+        // Empty arena has no blocks, find_last_set isn't defined for 0
+        if(granule_count == 0)
+        {
+            free_heads.clear();
+            return;
+        }
+
+        free_heads.assign(find_last_set(granule_count) + 1, NONE);
+
+        // Memory that isn't power of two large is split into the largest blocks that fit it
+        unsigned int granule = 0;
+        while(granule < granule_count)
+        {
+            unsigned int order = find_last_set(granule_count - granule);
+            insert_block(granule, order);
+            granule += 1u << order;
+        }
+    }
+
+    /**
+     * 
+     * @param size Requested size
+     * @return Size of the smallest block that can fit requested size
+     */
+    pool_size round_size(pool_size size) const
+    {
+        if(size == 0)
+            return 0;
+
+        return granule_size << get_order(size);
+    }
+
+    /**
+     * Picks the first free block of the smallest order that can fit requested size
+     * @param size Requested size, has to be rounded by round_size
+     * @param offset Offset of found block
+     * @return true if block was found, otherwise false
+     */
+    bool find(pool_size size, pool_size& offset) const
+    {
+        unsigned long long orders = order_mask & (~0ULL << get_order(size));
+        if(orders == 0)
+            return false;
+
+        offset = free_heads[count_trailing_zeros(orders)] * granule_size;
+        return true;
+    }
+
+    /**
+     * Block can grow in place only if it is aligned to the new size and all buddies it absorbs are free
+     * @param offset Offset of memory block
+     * @param old_size Current size of memory block
+     * @param new_size Requested size of memory block, has to be rounded by round_size
+     * @return true if memory block can be resized without moving it, otherwise false
+     */
+    bool can_resize(pool_size offset, pool_size old_size, pool_size new_size) const
+    {
+        if(new_size <= old_size)
+            return true;
+
+        unsigned int granule = static_cast<unsigned int>(offset / granule_size);
+        unsigned int new_order = get_order(new_size);
+
+        if(granule % (1u << new_order) != 0 || granule + (1u << new_order) > granule_count)
+            return false;
+
+        for(unsigned int order = get_order(old_size); order < new_order; order++)
+        {
+            if(free_order[granule + (1u << order)] != static_cast<signed char>(order))
+                return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Blocks have to stay aligned to their size, therefore block never grows into memory before it
+     * @return Always 0
+     */
+    pool_size gap_before(pool_size) const
+    {
+        return 0;
+    }
+
+    /**
+     * Splits free block found by find until it has requested size
+     * @param offset Offset of free block
+     * @param size Size of used memory, has to be rounded by round_size
+     */
+    void claim(pool_size offset, pool_size size)
+    {
+        unsigned int granule = static_cast<unsigned int>(offset / granule_size);
+        unsigned int order = static_cast<unsigned int>(free_order[granule]);
+        unsigned int requested_order = get_order(size);
+
+        remove_block(granule);
+
+        // Right halves of split block stay free
+        while(order > requested_order)
+        {
+            order--;
+            insert_block(granule + (1u << order), order);
+        }
+    }
+
+    /**
+     * Frees memory block and merges it with its free buddies
+     * @param offset Offset of released memory block
+     * @param size Size of released memory block
+     */
+    void release(pool_size offset, pool_size size)
+    {
+        unsigned int granule = static_cast<unsigned int>(offset / granule_size);
+        unsigned int order = get_order(size);
+
+        while(order + 1 < free_heads.size())
+        {
+            unsigned int buddy = granule ^ (1u << order);
+            if(buddy + (1u << order) > granule_count || free_order[buddy] != static_cast<signed char>(order))
+                break;
+
+            remove_block(buddy);
+            granule = granule < buddy ? granule : buddy;
+            order++;
+        }
+
+        insert_block(granule, order);
+    }
+
+    /**
+     * Grows block by absorbing its buddies or shrinks it by freeing its right halves, can_resize has to be checked first
+     * @param offset Offset of memory block
+     * @param old_size Current size of memory block
+     * @param new_size New size of memory block, has to be rounded by round_size
+     */
+    void resize(pool_size offset, pool_size old_size, pool_size new_size)
+    {
+        unsigned int granule = static_cast<unsigned int>(offset / granule_size);
+        unsigned int old_order = get_order(old_size);
+        unsigned int new_order = get_order(new_size);
+
+        for(unsigned int order = old_order; order < new_order; order++)
+        {
+            remove_block(granule + (1u << order));
+        }
+
+        // Left half of block stays used, therefore released right halves can't be merged with their buddies
+        for(unsigned int order = new_order; order < old_order; order++)
+        {
+            insert_block(granule + (1u << order), order);
+        }
+    }
+
+    /**
+     * 
+     * @return Size of the largest free block, 0 if memory is full
+     */
+    pool_size largest_gap() const
+    {
+        return order_mask == 0 ? 0 : granule_size << find_last_set(order_mask);
+    }
+
+private:
+    enum : unsigned int { NONE = 0xFFFFFFFF };
+
+    pool_size granule_size;
+    unsigned int granule_count;
+
+    // Order of free block starting at granule, -1 if no free block starts there
+    std::vector<signed char> free_order;
+
+    // Free lists of each order linked through granule of block start
+    std::vector<unsigned int> next_free;
+    std::vector<unsigned int> previous_free;
+    std::vector<unsigned int> free_heads;
+
+    // Bit n is set if there is free block of order n
+    unsigned long long order_mask = 0;
+
+    /**
+     * 
+     * @param size Size of memory block
+     * @return Order of the smallest block that can fit given size
+     */
+    unsigned int get_order(pool_size size) const
+    {
+        pool_size granules = (size + granule_size - 1) / granule_size;
+        if(granules <= 1)
+            return 0;
+
+        return find_last_set(granules - 1) + 1;
+    }
+
+    void insert_block(unsigned int granule, unsigned int order)
+    {
+        free_order[granule] = static_cast<signed char>(order);
+        previous_free[granule] = NONE;
+        next_free[granule] = free_heads[order];
+
+        if(free_heads[order] != NONE)
+            previous_free[free_heads[order]] = granule;
+
+        free_heads[order] = granule;
+        order_mask |= 1ULL << order;
+    }
+
+    void remove_block(unsigned int granule)
+    {
+        unsigned int order = static_cast<unsigned int>(free_order[granule]);
+
+        if(previous_free[granule] == NONE)
+            free_heads[order] = next_free[granule];
+        else
+            next_free[previous_free[granule]] = next_free[granule];
+
+        if(next_free[granule] != NONE)
+            previous_free[next_free[granule]] = previous_free[granule];
+
+        if(free_heads[order] == NONE)
+            order_mask &= ~(1ULL << order);
+
+        free_order[granule] = -1;
+    }
+};
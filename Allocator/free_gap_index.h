@@ -0,0 +1,196 @@
+﻿#pragma once
+#include <map>
+#include <set>
+#include <utility>
+#include "../Model/pool_size.h"
+
+/**
+ * Index of free memory gaps inside memory pool. Gaps are stored by their offset so neighbouring gaps can be merged
+ * and by their size so the best fitting gap is found in O(log n)
+ */
+class free_gap_index
+{
+public:
+    static const bool supports_compaction = true;
+    static const bool inline_compaction = true;
+
+    // Only free gaps are kept, memory of blocks placed back to back can be claimed at once
+    static const bool tracks_blocks = false;
+
+    free_gap_index(pool_size arena_size, pool_size granule_size)
+        : arena_size(arena_size), granule_size(granule_size)
+    {
+        reset();
+    }
+
+    /**
+     * Marks whole memory as free
+     */
+    void reset()
+    {
+        gaps_by_offset.clear();
+        gaps_by_size.clear();
+        insert_gap(0, arena_size);
+    }
+
+    /**
+     * 
+     * @param size Requested size
+     * @return Size of memory block that is allocated for requested size
+     */
+    pool_size round_size(pool_size size) const
+    {
+        return (size + granule_size - 1) / granule_size * granule_size;
+    }
+
+    /**
+     * Looks for the smallest gap that can fit requested size
+     * @param size Requested size
+     * @param offset Offset of found gap
+     * @return true if gap was found, otherwise false
+     */
+    bool find(pool_size size, pool_size& offset) const
+    {
+        auto it = gaps_by_size.lower_bound(std::make_pair(size, static_cast<pool_size>(0)));
+        if(it == gaps_by_size.end())
+            return false;
+
+        offset = it->second;
+        return true;
+    }
+
+    /**
+     * 
+     * @param offset Offset of the first byte after a memory block
+     * @return Size of gap starting at offset, 0 if memory at offset is used
+     */
+    pool_size gap_at(pool_size offset) const
+    {
+        auto it = gaps_by_offset.find(offset);
+        return it == gaps_by_offset.end() ? 0 : it->second;
+    }
+
+    /**
+     * 
+     * @param offset Offset of memory block
+     * @return Size of gap that ends right at offset, 0 if memory before offset is used
+     */
+    pool_size gap_before(pool_size offset) const
+    {
+        auto it = gaps_by_offset.lower_bound(offset);
+        if(it == gaps_by_offset.begin())
+            return 0;
+
+        it = std::prev(it);
+        return it->first + it->second == offset ? it->second : 0;
+    }
+
+    /**
+     * 
+     * @param offset Offset of memory block
+     * @param old_size Current size of memory block
+     * @param new_size Requested size of memory block
+     * @return true if memory block can be resized without moving it, otherwise false
+     */
+    bool can_resize(pool_size offset, pool_size old_size, pool_size new_size) const
+    {
+        return new_size <= old_size || old_size + gap_at(offset + old_size) >= new_size;
+    }
+
+    /**
+     * Marks memory as used, memory has to be free
+     * @param offset Offset of used memory
+     * @param size Size of used memory
+     */
+    void claim(pool_size offset, pool_size size)
+    {
+        if(size == 0)
+            return;
+
+        // Gap containing claimed memory is the last one starting before or at offset
+        auto it = std::prev(gaps_by_offset.upper_bound(offset));
+        pool_size gap_offset = it->first;
+        pool_size gap_size = it->second;
+
+        erase_gap(it);
+
+        if(offset > gap_offset)
+            insert_gap(gap_offset, offset - gap_offset);
+
+        if(offset + size < gap_offset + gap_size)
+            insert_gap(offset + size, gap_offset + gap_size - offset - size);
+    }
+
+    /**
+     * Marks memory as free and merges it with neighbouring gaps
+     * @param offset Offset of released memory
+     * @param size Size of released memory
+     */
+    void release(pool_size offset, pool_size size)
+    {
+        if(size == 0)
+            return;
+
+        auto next = gaps_by_offset.lower_bound(offset);
+
+        if(next != gaps_by_offset.begin())
+        {
+            auto previous = std::prev(next);
+            if(previous->first + previous->second == offset)
+            {
+                offset = previous->first;
+                size += previous->second;
+                erase_gap(previous);
+            }
+        }
+
+        if(next != gaps_by_offset.end() && next->first == offset + size)
+        {
+            size += next->second;
+            erase_gap(next);
+        }
+
+        insert_gap(offset, size);
+    }
+
+    /**
+     * Resizes memory block without moving it, can_resize has to be checked first
+     * @param offset Offset of memory block
+     * @param old_size Current size of memory block
+     * @param new_size New size of memory block
+     */
+    void resize(pool_size offset, pool_size old_size, pool_size new_size)
+    {
+        if(new_size > old_size)
+            claim(offset + old_size, new_size - old_size);
+        else
+            release(offset + new_size, old_size - new_size);
+    }
+
+    /**
+     * 
+     * @return Size of the largest gap, 0 if memory is full
+     */
+    pool_size largest_gap() const
+    {
+        return gaps_by_size.empty() ? 0 : gaps_by_size.rbegin()->first;
+    }
+
+private:
+    pool_size arena_size;
+    pool_size granule_size;
+    std::map<pool_size, pool_size> gaps_by_offset;
+    std::set<std::pair<pool_size, pool_size>> gaps_by_size;
+
+    void insert_gap(pool_size offset, pool_size size)
+    {
+        gaps_by_offset.emplace(offset, size);
+        gaps_by_size.emplace(size, offset);
+    }
+
+    void erase_gap(std::map<pool_size, pool_size>::iterator it)
+    {
+        gaps_by_size.erase(std::make_pair(it->second, it->first));
+        gaps_by_offset.erase(it);
+    }
+};
@@ -0,0 +1,319 @@
+﻿#pragma once
+#include <vector>
+#include "bitmap_allocator.h"
+#include "bit_operations.h"
+#include "../Model/pool_size.h"
+
+typedef struct slab_occupancy
+{
+    pool_size BlockSize = 0;
+    unsigned int SlabCount = 0;
+    unsigned int UsedBlocks = 0;
+    unsigned int TotalBlocks = 0;
+    
+} slab_occupancy;
+
+/**
+ * Size class slab allocator. Memory is carved into slabs of SLAB_GRANULES granules, each slab holds blocks of single size class
+ * (1, 2 or 4 granules). Slabs with free blocks are kept in a list per class and free blocks of slab in a bitmask,
+ * therefore allocation of class block is pop from the list. Blocks larger than the largest class take run of whole slabs
+ */
+class slab_allocator
+{
+public:
+    enum : unsigned int { CLASS_COUNT = 3, SLAB_GRANULES = 8 };
+
+    // Block can't be moved out of its slot, therefore memory can't be bunched together
+    static const bool supports_compaction = false;
+    static const bool inline_compaction = false;
+    static const bool tracks_blocks = true;
+
+    slab_allocator(pool_size arena_size, pool_size granule_size)
+        : granule_size(granule_size), slab_size(granule_size * SLAB_GRANULES), slab_count(static_cast<unsigned int>(arena_size / (granule_size * SLAB_GRANULES))),
+          slabs(arena_size / (granule_size * SLAB_GRANULES) * granule_size * SLAB_GRANULES, granule_size * SLAB_GRANULES)
+    {
+        reset();
+    }
+
+    /**
+     * Marks whole memory as free
+     */
+    void reset()
+    {
+        slabs.reset();
+        slab_class.assign(slab_count, FREE_SLAB);
+        free_slots.assign(slab_count, 0);
+        run_length.assign(slab_count, 0);
+        next_partial.assign(slab_count, NONE);
+        previous_partial.assign(slab_count, NONE);
+
+        for(unsigned int class_index = 0; class_index <= CLASS_COUNT; class_index++)
+        {
+            partial_heads[class_index] = NONE;
+            occupancy[class_index] = slab_occupancy();
+            occupancy[class_index].BlockSize = class_index < CLASS_COUNT ? granule_size << class_index : slab_size;
+        }
+    }
+
+    /**
+     * 
+     * @param size Requested size
+     * @return Block size of the smallest class that fits requested size, multiple of slab size for larger sizes
+     */
+    pool_size round_size(pool_size size) const
+    {
+        if(size == 0)
+            return 0;
+
+        unsigned int class_index = get_class(size);
+        if(class_index < CLASS_COUNT)
+            return granule_size << class_index;
+
+        return (size + slab_size - 1) / slab_size * slab_size;
+    }
+
+    /**
+     * Looks for a free block in slab of requested class, empty slab is used if no slab of the class has free block
+     * @param size Requested size, has to be rounded by round_size
+     * @param offset Offset of found block
+     * @return true if block was found, otherwise false
+     */
+    bool find(pool_size size, pool_size& offset) const
+    {
+        unsigned int class_index = get_class(size);
+
+        if(class_index < CLASS_COUNT && partial_heads[class_index] != NONE)
+        {
+            unsigned int slab = partial_heads[class_index];
+            offset = slab * slab_size + count_trailing_zeros(free_slots[slab]) * (granule_size << class_index);
+            return true;
+        }
+
+        return slabs.find(class_index < CLASS_COUNT ? slab_size : size, offset);
+    }
+
+    /**
+     * Class block always holds its whole slot, so it can't be resized in place. Blocks made of whole slabs can take following
+     * free slabs or release slabs at their end, but they can't shrink below a single slab
+     * @param offset Offset of memory block
+     * @param new_size Requested size of memory block, has to be rounded by round_size
+     * @return true if memory block can be resized without moving it, otherwise false
+     */
+    bool can_resize(pool_size offset, pool_size, pool_size new_size) const
+    {
+        unsigned int slab = static_cast<unsigned int>(offset / slab_size);
+
+        if(slab_class[slab] != LARGE_SLABS)
+            return new_size == occupancy[slab_class[slab]].BlockSize;
+
+        if(new_size < slab_size)
+            return false;
+
+        return new_size <= run_length[slab] * slab_size || slabs.can_resize(offset, run_length[slab] * slab_size, new_size);
+    }
+
+    /**
+     * Blocks keep their slot, therefore block never grows into memory before it
+     * @return Always 0
+     */
+    pool_size gap_before(pool_size) const
+    {
+        return 0;
+    }
+
+    /**
+     * Marks block found by find as used
+     * @param offset Offset of free block
+     * @param size Size of used memory, has to be rounded by round_size
+     */
+    void claim(pool_size offset, pool_size size)
+    {
+        if(size == 0)
+            return;
+
+        unsigned int class_index = get_class(size);
+        unsigned int slab = static_cast<unsigned int>(offset / slab_size);
+
+        if(class_index == CLASS_COUNT)
+        {
+            slabs.claim(offset, size);
+            slab_class[slab] = LARGE_SLABS;
+            run_length[slab] = static_cast<unsigned int>(size / slab_size);
+            occupancy[CLASS_COUNT].SlabCount += run_length[slab];
+            occupancy[CLASS_COUNT].UsedBlocks++;
+            occupancy[CLASS_COUNT].TotalBlocks++;
+            return;
+        }
+
+        if(slab_class[slab] == FREE_SLAB)
+        {
+            // Empty slab is carved into blocks of requested class
+            slabs.claim(slab * slab_size, slab_size);
+            slab_class[slab] = static_cast<signed char>(class_index);
+            free_slots[slab] = (1u << (SLAB_GRANULES >> class_index)) - 1;
+            push_partial(slab);
+            occupancy[class_index].SlabCount++;
+            occupancy[class_index].TotalBlocks += SLAB_GRANULES >> class_index;
+        }
+
+        free_slots[slab] &= ~(1u << ((offset % slab_size) / (granule_size << class_index)));
+        occupancy[class_index].UsedBlocks++;
+
+        if(free_slots[slab] == 0)
+            remove_partial(slab);
+    }
+
+    /**
+     * Returns block to its slab, slab without used blocks is released
+     * @param offset Offset of released memory block
+     * @param size Size of released memory block
+     */
+    void release(pool_size offset, pool_size size)
+    {
+        if(size == 0)
+            return;
+
+        unsigned int slab = static_cast<unsigned int>(offset / slab_size);
+
+        if(slab_class[slab] == LARGE_SLABS)
+        {
+            slabs.release(offset, run_length[slab] * slab_size);
+            occupancy[CLASS_COUNT].SlabCount -= run_length[slab];
+            occupancy[CLASS_COUNT].UsedBlocks--;
+            occupancy[CLASS_COUNT].TotalBlocks--;
+            slab_class[slab] = FREE_SLAB;
+            run_length[slab] = 0;
+            return;
+        }
+
+        unsigned int class_index = static_cast<unsigned int>(slab_class[slab]);
+        unsigned int all_slots = (1u << (SLAB_GRANULES >> class_index)) - 1;
+
+        if(free_slots[slab] == 0)
+            push_partial(slab);
+
+        free_slots[slab] |= 1u << ((offset % slab_size) / (granule_size << class_index));
+        occupancy[class_index].UsedBlocks--;
+
+        if(free_slots[slab] == all_slots)
+        {
+            remove_partial(slab);
+            slabs.release(slab * slab_size, slab_size);
+            slab_class[slab] = FREE_SLAB;
+            occupancy[class_index].SlabCount--;
+            occupancy[class_index].TotalBlocks -= SLAB_GRANULES >> class_index;
+        }
+    }
+
+    /**
+     * Blocks made of whole slabs take or release slabs at their end. can_resize has to be checked first
+     * @param offset Offset of memory block
+     * @param new_size New size of memory block, has to be rounded by round_size
+     */
+    void resize(pool_size offset, pool_size, pool_size new_size)
+    {
+        unsigned int slab = static_cast<unsigned int>(offset / slab_size);
+        if(slab_class[slab] != LARGE_SLABS)
+            return;
+
+        unsigned int new_length = static_cast<unsigned int>((new_size + slab_size - 1) / slab_size);
+        if(new_length == run_length[slab])
+            return;
+
+        slabs.resize(offset, run_length[slab] * slab_size, new_length * slab_size);
+        occupancy[CLASS_COUNT].SlabCount += new_length;
+        occupancy[CLASS_COUNT].SlabCount -= run_length[slab];
+        run_length[slab] = new_length;
+    }
+
+    /**
+     * 
+     * @return Size of the largest block that can be allocated, 0 if memory is full
+     */
+    pool_size largest_gap() const
+    {
+        pool_size largest = slabs.largest_gap();
+
+        for(unsigned int class_index = 0; class_index < CLASS_COUNT; class_index++)
+        {
+            if(partial_heads[class_index] != NONE && occupancy[class_index].BlockSize > largest)
+                largest = occupancy[class_index].BlockSize;
+        }
+
+        return largest;
+    }
+
+    /**
+     * 
+     * @param class_index Index of size class, CLASS_COUNT returns blocks made of whole slabs
+     * @return Count of slabs and used / total blocks of size class
+     */
+    slab_occupancy get_occupancy(unsigned int class_index) const
+    {
+        return occupancy[class_index];
+    }
+
+private:
+    enum : unsigned int { NONE = 0xFFFFFFFF };
+    enum : signed char { FREE_SLAB = -1, LARGE_SLABS = CLASS_COUNT };
+
+    pool_size granule_size;
+    pool_size slab_size;
+    unsigned int slab_count;
+
+    // Free and used slabs, blocks larger than the largest class take runs of slabs from it
+    bitmap_allocator slabs;
+
+    // Class of blocks in slab, FREE_SLAB or LARGE_SLABS for first slab of run
+    std::vector<signed char> slab_class;
+    std::vector<unsigned int> free_slots;
+    std::vector<unsigned int> run_length;
+
+    // Slabs of each class with at least one free block
+    std::vector<unsigned int> next_partial;
+    std::vector<unsigned int> previous_partial;
+    unsigned int partial_heads[CLASS_COUNT + 1];
+
+    slab_occupancy occupancy[CLASS_COUNT + 1];
+
+    /**
+     * 
+     * @param size Size of memory block
+     * @return Index of the smallest class that fits given size, CLASS_COUNT if size is larger than the largest class
+     */
+    unsigned int get_class(pool_size size) const
+    {
+        pool_size granules = (size + granule_size - 1) / granule_size;
+        if(granules <= 1)
+            return 0;
+
+        unsigned int class_index = find_last_set(granules - 1) + 1;
+        return class_index < CLASS_COUNT ? class_index : CLASS_COUNT;
+    }
+
+    void push_partial(unsigned int slab)
+    {
+        unsigned int class_index = static_cast<unsigned int>(slab_class[slab]);
+
+        previous_partial[slab] = NONE;
+        next_partial[slab] = partial_heads[class_index];
+
+        if(partial_heads[class_index] != NONE)
+            previous_partial[partial_heads[class_index]] = slab;
+
+        partial_heads[class_index] = slab;
+    }
+
+    void remove_partial(unsigned int slab)
+    {
+        unsigned int class_index = static_cast<unsigned int>(slab_class[slab]);
+
+        if(previous_partial[slab] == NONE)
+            partial_heads[class_index] = next_partial[slab];
+        else
+            next_partial[previous_partial[slab]] = next_partial[slab];
+
+        if(next_partial[slab] != NONE)
+            previous_partial[next_partial[slab]] = previous_partial[slab];
+    }
+};
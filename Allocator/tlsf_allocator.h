@@ -0,0 +1,401 @@
+﻿#pragma once
+#include <vector>
+#include <unordered_map>
+#include "bit_operations.h"
+#include "../Model/pool_size.h"
+
+/**
+ * Two-level segregated fit allocator. Free blocks are sorted to lists by size - first level splits sizes by powers of two,
+ * second level splits each power of two linearly to SL_COUNT ranges. Non-empty lists are tracked in bitmaps, therefore
+ * both finding a fitting block and releasing a block take O(1). Neighbouring free blocks are merged immediately
+ * Block headers are preallocated for every granule, so claim and release never allocate memory. With POOL_64BIT_SIZES arena can span
+ * billions of granules, headers are kept only for granules where a block starts then and allocator memory grows with count of blocks
+ */
+class tlsf_allocator
+{
+public:
+    static const bool supports_compaction = true;
+
+    // Allocation that doesn't fit fails instead of organizing memory, so enqueue and dequeue stay O(1)
+    // Memory is organized only by explicit try_organize_memory / compact_step calls
+    static const bool inline_compaction = false;
+
+    // Header is kept for every block, so each block has to be claimed on its own
+    static const bool tracks_blocks = true;
+
+    tlsf_allocator(pool_size arena_size, pool_size granule_size)
+        : granule_size(granule_size), granule_count(static_cast<unsigned int>(arena_size / granule_size))
+    {
+        reset();
+    }
+
+    /**
+     * Marks whole memory as free
+     */
+    void reset()
+    {
+        unsigned int first_level = 0;
+        unsigned int second_level = 0;
+        get_mapping(granule_count, first_level, second_level);
+
+#if POOL_64BIT_SIZES
+        blocks.clear();
+#else
+        blocks.assign(granule_count, block_header{ 0, NONE, NONE, NONE, false });
+#endif
+        free_heads.assign((first_level + 1) * SL_COUNT, NONE);
+        sl_bitmap.assign(first_level + 1, 0);
+        fl_bitmap = 0;
+
+        if(granule_count == 0)
+            return;
+
+        blocks[0] = block_header{ granule_count, NONE, NONE, NONE, false };
+        insert_free(0);
+    }
+
+    /**
+     * 
+     * @param size Requested size
+     * @return Size of memory block that is allocated for requested size
+     */
+    pool_size round_size(pool_size size) const
+    {
+        return (size + granule_size - 1) / granule_size * granule_size;
+    }
+
+    /**
+     * Looks for a free block in the list of requested size first, then in the first non-empty list whose blocks are all large enough for it
+     * @param size Requested size, multiple of granule size
+     * @param offset Offset of found block
+     * @return true if block was found, otherwise false
+     */
+    bool find(pool_size size, pool_size& offset) const
+    {
+        unsigned int count = static_cast<unsigned int>(size / granule_size);
+        unsigned int first_level = 0;
+        unsigned int second_level = 0;
+        get_mapping(count, first_level, second_level);
+
+        if(first_level >= sl_bitmap.size())
+            return false;
+
+        // Blocks of the list of requested size can be smaller than it, only the first one is checked so find stays O(1)
+        unsigned int head = free_heads[first_level * SL_COUNT + second_level];
+        if(head != NONE && header(head).Size >= count)
+        {
+            offset = head * granule_size;
+            return true;
+        }
+
+        // Size is rounded up to the next list, so any block of found list can fit it
+        if(count >= SL_COUNT)
+        {
+            count += (1u << (find_last_set(count) - SL_LOG2)) - 1;
+            get_mapping(count, first_level, second_level);
+
+            if(first_level >= sl_bitmap.size())
+                return false;
+        }
+
+        unsigned int sl_map = sl_bitmap[first_level] & (~0u << second_level);
+        if(sl_map == 0)
+        {
+            unsigned long long fl_map = fl_bitmap & (~0ULL << (first_level + 1));
+            if(fl_map == 0)
+                return false;
+
+            first_level = count_trailing_zeros(fl_map);
+            sl_map = sl_bitmap[first_level];
+        }
+
+        second_level = count_trailing_zeros(sl_map);
+        offset = free_heads[first_level * SL_COUNT + second_level] * granule_size;
+        return true;
+    }
+
+    /**
+     * 
+     * @param offset Offset of memory block
+     * @param old_size Current size of memory block
+     * @param new_size Requested size of memory block
+     * @return true if memory block can be resized without moving it, otherwise false
+     */
+    bool can_resize(pool_size offset, pool_size old_size, pool_size new_size) const
+    {
+        if(new_size <= old_size)
+            return true;
+
+        unsigned int next = static_cast<unsigned int>((offset + old_size) / granule_size);
+        if(next >= granule_count || header(next).Free == false)
+            return false;
+
+        return old_size / granule_size + header(next).Size >= new_size / granule_size;
+    }
+
+    /**
+     * 
+     * @param offset Offset of memory block
+     * @return Size of free block that ends right at offset, 0 if block before offset is used
+     */
+    pool_size gap_before(pool_size offset) const
+    {
+        unsigned int previous = header(static_cast<unsigned int>(offset / granule_size)).Previous;
+        return previous != NONE && header(previous).Free ? header(previous).Size * granule_size : 0;
+    }
+
+    /**
+     * Takes requested size from start of free block, rest of the block stays free
+     * @param offset Offset of free block
+     * @param size Size of used memory, multiple of granule size
+     */
+    void claim(pool_size offset, pool_size size)
+    {
+        unsigned int block = static_cast<unsigned int>(offset / granule_size);
+        unsigned int count = static_cast<unsigned int>(size / granule_size);
+        if(count == 0)
+            return;
+
+        remove_free(block);
+
+        unsigned int block_count = header(block).Size;
+        if(block_count > count)
+            split_block(block, count, block_count - count);
+    }
+
+    /**
+     * Frees memory block and merges it with free neighbouring blocks
+     * @param offset Offset of released memory block
+     * @param size Size of released memory block
+     */
+    void release(pool_size offset, pool_size size)
+    {
+        unsigned int block = static_cast<unsigned int>(offset / granule_size);
+        if(size == 0)
+            return;
+
+        unsigned int next = block + header(block).Size;
+        if(next < granule_count && header(next).Free)
+        {
+            remove_free(next);
+            header(block).Size += header(next).Size;
+            erase_header(next);
+        }
+
+        unsigned int previous = header(block).Previous;
+        if(previous != NONE && header(previous).Free)
+        {
+            remove_free(previous);
+            header(previous).Size += header(block).Size;
+            erase_header(block);
+            block = previous;
+        }
+
+        link_next_block(block);
+        insert_free(block);
+    }
+
+    /**
+     * Grows block by taking start of the next free block or shrinks it by releasing its end, can_resize has to be checked first
+     * @param offset Offset of memory block
+     * @param old_size Current size of memory block
+     * @param new_size New size of memory block, multiple of granule size
+     */
+    void resize(pool_size offset, pool_size old_size, pool_size new_size)
+    {
+        unsigned int block = static_cast<unsigned int>(offset / granule_size);
+        unsigned int old_count = static_cast<unsigned int>(old_size / granule_size);
+        unsigned int new_count = static_cast<unsigned int>(new_size / granule_size);
+        unsigned int next = block + old_count;
+        unsigned int total = old_count;
+
+        if(next < granule_count && header(next).Free)
+        {
+            remove_free(next);
+            total += header(next).Size;
+            erase_header(next);
+        }
+
+        header(block).Size = total;
+
+        if(total > new_count)
+            split_block(block, new_count, total - new_count);
+        else
+            link_next_block(block);
+    }
+
+    /**
+     * Walks free blocks of the highest non-empty list, so it takes O(n) in count of blocks in that list unlike find and release
+     * It is used only to measure fragmentation, allocation never calls it
+     * @return Size of the largest free block, 0 if memory is full
+     */
+    pool_size largest_gap() const
+    {
+        if(fl_bitmap == 0)
+            return 0;
+
+        // Only blocks of the highest non-empty list can be the largest ones
+        unsigned int first_level = find_last_set(fl_bitmap);
+        unsigned int second_level = find_last_set(sl_bitmap[first_level]);
+        unsigned int largest = 0;
+
+        for(unsigned int block = free_heads[first_level * SL_COUNT + second_level]; block != NONE; block = header(block).NextFree)
+        {
+            if(header(block).Size > largest)
+                largest = header(block).Size;
+        }
+
+        return largest * granule_size;
+    }
+
+private:
+    enum : unsigned int { NONE = 0xFFFFFFFF };
+    enum : unsigned int { SL_LOG2 = 3, SL_COUNT = 1 << SL_LOG2 };
+
+    pool_size granule_size;
+    unsigned int granule_count;
+
+    struct block_header
+    {
+        // Size of block in granules
+        unsigned int Size;
+        // Granule of the block right before this one, NONE for the first block
+        unsigned int Previous;
+        // Neighbouring blocks in list of free blocks, NONE if there is none
+        unsigned int NextFree;
+        unsigned int PreviousFree;
+        bool Free;
+    };
+
+    // Blocks are described by header stored under granule they start at
+#if POOL_64BIT_SIZES
+    std::unordered_map<unsigned int, block_header> blocks;
+#else
+    std::vector<block_header> blocks;
+#endif
+
+    // List of free blocks for each first / second level pair and bitmaps of non-empty lists
+    std::vector<unsigned int> free_heads;
+    std::vector<unsigned int> sl_bitmap;
+    unsigned long long fl_bitmap = 0;
+
+#if POOL_64BIT_SIZES
+    block_header& header(unsigned int block)
+    {
+        return blocks.find(block)->second;
+    }
+
+    const block_header& header(unsigned int block) const
+    {
+        return blocks.find(block)->second;
+    }
+
+    // Header of block merged into its neighbour is removed, so only granules where a block starts keep one
+    void erase_header(unsigned int block)
+    {
+        blocks.erase(block);
+    }
+#else
+    block_header& header(unsigned int block)
+    {
+        return blocks[block];
+    }
+
+    const block_header& header(unsigned int block) const
+    {
+        return blocks[block];
+    }
+
+    // Preallocated header stays in place, it is overwritten once a block starts at its granule again
+    void erase_header(unsigned int)
+    {
+    }
+#endif
+
+    /**
+     * 
+     * @param count Size of block in granules
+     * @param first_level First level index, sizes below SL_COUNT have first level 0 and are not split further
+     * @param second_level Second level index
+     */
+    static void get_mapping(unsigned int count, unsigned int& first_level, unsigned int& second_level)
+    {
+        if(count < SL_COUNT)
+        {
+            first_level = 0;
+            second_level = count;
+            return;
+        }
+
+        unsigned int highest_bit = find_last_set(count);
+        first_level = highest_bit - SL_LOG2 + 1;
+        second_level = (count >> (highest_bit - SL_LOG2)) - SL_COUNT;
+    }
+
+    /**
+     * Splits block to used part of given size and free rest
+     */
+    void split_block(unsigned int block, unsigned int count, unsigned int rest_count)
+    {
+        unsigned int rest = block + count;
+
+        header(block).Size = count;
+        blocks[rest] = block_header{ rest_count, block, NONE, NONE, false };
+
+        link_next_block(rest);
+        insert_free(rest);
+    }
+
+    void link_next_block(unsigned int block)
+    {
+        unsigned int next = block + header(block).Size;
+        if(next < granule_count)
+            header(next).Previous = block;
+    }
+
+    void insert_free(unsigned int block)
+    {
+        unsigned int first_level = 0;
+        unsigned int second_level = 0;
+        block_header& inserted = header(block);
+        get_mapping(inserted.Size, first_level, second_level);
+        unsigned int list = first_level * SL_COUNT + second_level;
+
+        inserted.PreviousFree = NONE;
+        inserted.NextFree = free_heads[list];
+        inserted.Free = true;
+
+        if(free_heads[list] != NONE)
+            header(free_heads[list]).PreviousFree = block;
+
+        free_heads[list] = block;
+        sl_bitmap[first_level] |= 1u << second_level;
+        fl_bitmap |= 1ULL << first_level;
+    }
+
+    void remove_free(unsigned int block)
+    {
+        unsigned int first_level = 0;
+        unsigned int second_level = 0;
+        block_header& removed = header(block);
+        get_mapping(removed.Size, first_level, second_level);
+        unsigned int list = first_level * SL_COUNT + second_level;
+
+        if(removed.PreviousFree == NONE)
+            free_heads[list] = removed.NextFree;
+        else
+            header(removed.PreviousFree).NextFree = removed.NextFree;
+
+        if(removed.NextFree != NONE)
+            header(removed.NextFree).PreviousFree = removed.PreviousFree;
+
+        removed.Free = false;
+
+        if(free_heads[list] == NONE)
+        {
+            sl_bitmap[first_level] &= ~(1u << second_level);
+            if(sl_bitmap[first_level] == 0)
+                fl_bitmap &= ~(1ULL << first_level);
+        }
+    }
+};
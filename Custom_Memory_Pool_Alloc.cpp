@@ -1,751 +1,1215 @@
-#include <algorithm>
-#include <iostream>
-#include <list>
-#include <memory>
-#include <signal.h>
-#include "Model/byte_queue.h"
+#include "Pool/memory_pool.h"
+#include "Pool/pool_compactor.h"
 
-// We assume that no more than 64 will be allocated at once: 2048 / 64 = 32. This way we ensure that on default we can fit all 64 queues
-#define DEFAULT_ALLOC_SIZE  32
-#define MAX_QUEUE_COUNT     64
-#define MEMORY_ALLOC_SIZE   2048
-
-byte_queue queues[64];
-unsigned char data[MEMORY_ALLOC_SIZE];
-
-
-/**
- * https://learn.microsoft.com/en-us/cpp/c-runtime-library/reference/signal?view=msvc-170
- * Terminates program using signal call SIGABRT - Signal Abort - Abnormal termination
- */
-void on_out_of_memory()
+void Test_SCSTest()
 {
-    std::cout << "Program ran out of memory!";
-    int _ = raise(SIGABRT);
+    memory_pool pool;
+    byte_queue* q0 = pool.create_queue();
+    pool.enqueue_byte(q0, 0);  // Queue 0: [0]
+    pool.enqueue_byte(q0, 1);  // Queue 0: [0, 1]
+    byte_queue* q1 = pool.create_queue();
+    pool.enqueue_byte(q1, 3);  // Queue 1: [3]
+    pool.enqueue_byte(q0, 2);  // Queue 0: [0, 1, 2]
+    pool.enqueue_byte(q1, 4);  // Queue 1: [3, 4]
+    printf("%d ", pool.dequeue_byte(q0)); // Expected output: 0
+    printf("%d\n", pool.dequeue_byte(q0)); // Expected output: 1
+    pool.enqueue_byte(q0, 5);  // Queue 0: [2, 5]
+    pool.enqueue_byte(q1, 6);  // Queue 1: [3, 4, 6]
+    printf("%d ", pool.dequeue_byte(q0)); // Expected output: 2
+    printf("%d\n", pool.dequeue_byte(q0)); // Expected output: 5
+    pool.destroy_queue(q0); // Destroy queue 0
+    printf("%d ", pool.dequeue_byte(q1)); // Expected output: 3
+    printf("%d ", pool.dequeue_byte(q1)); // Expected output: 4
+    printf("%d\n", pool.dequeue_byte(q1)); // Expected output: 6
+    pool.destroy_queue(q1); // Destroy queue 1
 }
 
-/**
- * https://learn.microsoft.com/en-us/cpp/c-runtime-library/reference/signal?view=msvc-170
- * Terminates program using signal call SIGILL - Invalid instruction 
- */
-void on_illegal_operation()
+void Test_FillQueues(memory_pool& pool)
 {
-    std::cout << "Illegal operation recorded!";
-    int _ = raise(SIGILL);
+    for(int i = 0; i < MAX_QUEUE_COUNT; i++)
+    {
+        byte_queue* temp = pool.create_queue();
+
+        for(int j = 1; j <= DEFAULT_ALLOC_SIZE; j++)
+        {
+            pool.enqueue_byte(temp, static_cast<unsigned char>(j));
+        }
+    }
 }
 
-/**
- * Reorganizes given array of queues
- * @param entry Array of byte queues
- * @return Sorted byte queues by Pointer (Memory location they point to)
- */
-byte_queue* reorganize_byte_queues(byte_queue entry[64])
+void Test_Reallocation()
 {
-    std::sort(entry, entry + MAX_QUEUE_COUNT, [](const byte_queue &q1, const byte_queue &q2)
+    memory_pool pool;
+    byte_queue* q1 = pool.create_queue();
+    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
     {
-        // Sort by activity (active / inactive)
-       if(q1.bIs_Active != q2.bIs_Active)
-           return q1.bIs_Active > q2.bIs_Active;
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+    }
 
-        // Sort by memory location
-        return q1.MemoryBlockPtr < q2.MemoryBlockPtr;
-    });
+    byte_queue* q2 = pool.create_queue();
+    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+    {
+        pool.enqueue_byte(q2, static_cast<unsigned char>(i));
+    }
 
-    return entry;
+    for(int i = 33; i <= DEFAULT_ALLOC_SIZE * 2; i++)
+    {
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+    }
 }
 
-/**
- * 
- * @return First active queue, nullptr if none is active
- */
-byte_queue* get_first_queue()
+void Test_Reallocation_2()
 {
-    byte_queue temp[64];
-    std::copy(std::begin(queues), std::end(queues), std::begin(temp));
-    
-    reorganize_byte_queues(temp);
-    
-    for (auto& queue : temp)
+    memory_pool pool;
+    // ----------- 1. section -----------
+    // q1, q2 and q2 start with 32 elements each
+    byte_queue* q1 = pool.create_queue();
+    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
     {
-        if(queue.bIs_Active == true)
-            return &queue;
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
     }
 
-    return nullptr;
+    byte_queue* q2 = pool.create_queue();
+    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+    {
+        pool.enqueue_byte(q2, static_cast<unsigned char>(i));
+    }
+
+    byte_queue* q3 = pool.create_queue();
+    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+    {
+        pool.enqueue_byte(q3, static_cast<unsigned char>(i));
+    }
+
+    // ----------- 2. section -----------
+    // q2 is destroyed to release memory
+    pool.destroy_queue(q2);
+
+    // ----------- 3. section -----------
+    // q1 allocates another 32 elements - this should test that q1 can be simply resized as there is 32 bytes free between q1 and q3
+
+    for(int i = 33; i <= DEFAULT_ALLOC_SIZE * 2; i++)
+    {
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+    }
+
+    // ----------- 4. section -----------
+    // remove 48 bytes from q1 to free some space between q1 and q3 - enough for q2 - q1 allocation size is lowered to 32 as 32 is enough to fit 16 bytes.
+    // therefore q1 won't occupy too much of memory as it doesn't need
+    for(int i = 1; i <= 48; i++)
+    {
+        printf("Byte removed from q1: %d\n", pool.dequeue_byte(q1));
+    }
+
+    // ----------- 5. section -----------
+    // create q2 and fill it with 32 bytes
+    q2 = pool.create_queue();
+    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+    {
+        pool.enqueue_byte(q2, static_cast<unsigned char>(i));
+    }
+
+    // Final result:
+    // q1 -> q2 -> q3
+    // q1 has 16 Size (32 Alloc)
+    // q2 has 32 Size (32 Alloc)
+    // q3 has 32 Size (32 Alloc)
 }
 
-/**
- * 
- * @param queue Target queue
- * @return First active queue located after given queue, nullptr if none other is active
- */
-byte_queue* get_next_queue(const byte_queue& queue)
+void Test_Reallocation_3()
 {
-    bool foundQueue = false;
+    memory_pool pool;
+    // ----------- 1. section -----------
+    // start with q1, q2, q3, q4 with 32 elements. q5 will start with 33, therefore will be moved "Behind" q6 after adding 33rd character as 33 bytes can't fit to 32 bytes sized memory
+    
+    byte_queue* q1 = pool.create_queue();
+    byte_queue* q2 = pool.create_queue();
+    byte_queue* q3 = pool.create_queue();
+    byte_queue* q4 = pool.create_queue();
+    byte_queue* q5 = pool.create_queue();
 
-    for(auto& byte : queues)
+    pool.enqueue_byte(q5, 0x0);
+    
+    byte_queue* q6 = pool.create_queue();
+
+    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
     {
-        if(foundQueue == false && byte.MemoryBlockPtr == queue.MemoryBlockPtr)
-        {
-            foundQueue = true;
-            continue;
-        }
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q2, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q3, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q4, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q5, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q6, static_cast<unsigned char>(i));
+    }
+
+    // ----------- 2. section -----------
+    // Destroy q3 and q4 to release memory
+    
+    pool.destroy_queue(q3);
+    pool.destroy_queue(q4);
+
+    q3 = nullptr;
+    q4 = nullptr;
 
-        if(foundQueue && byte.bIs_Active == true)
-            return &byte;
+    // ----------- 3. section -----------
+    // create 4 new queues and fill them with 32 bytes
+    // q11, q12 and q13 will be placed between q2 and q6 (q5 was reallocated after q6, therefore there are 3 * 32 bytes free)
+    // q14 will be placed after q5 (because q5 is located after q6 due to its increased size to 64 bytes)
+
+    byte_queue* q11 = pool.create_queue();
+    byte_queue* q12 = pool.create_queue();
+    byte_queue* q13 = pool.create_queue();
+    byte_queue* q14 = pool.create_queue();
+    
+    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+    {
+        pool.enqueue_byte(q11, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q12, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q13, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q14, static_cast<unsigned char>(i));
     }
     
-    return nullptr;
+    // Final result:
+    // q3 and q4 are NULL as they were destroyed. They no longer hold pointer to queues in array that are now used by other pointers
+    
+    // q1 -> q2 -> q11 -> q12 -> q13 -> q6 -> q5 -> q14
+    // q1 has 32 Size (32 Alloc)  (Memory Location = start of arena)
+    // q2 has 32 Size (32 Alloc)  (Memory Location = q1->MemoryBlockPtr + 32)
+    // q11 has 32 Size (32 Alloc) (Memory Location = q2->MemoryBlockPtr + 32)
+    // q12 has 32 Size (32 Alloc) (Memory Location = q11->MemoryBlockPtr + 32)
+    // q13 has 32 Size (32 Alloc) (Memory Location = q12->MemoryBlockPtr + 32)
+    // q6 has 32 Size (32 Alloc)  (Memory Location = q13->MemoryBlockPtr + 32)
+    // q5 has 33 Size (64 Alloc)  (Memory Location = q6->MemoryBlockPtr + 32)
+    // q14 has 32 Size (32 Alloc) (Memory Location = q5->MemoryBlockPtr + 64)
 }
 
-/**
- * 
- * @return Last active queue, nullptr if none is active
- */
-byte_queue* get_last_queue()
+void Test_InvalidOperation()
 {
-    byte_queue temp[64];
-    std::copy(std::begin(queues), std::end(queues), std::begin(temp));
+    memory_pool pool;
+    byte_queue* q1 = pool.create_queue();
+    pool.dequeue_byte(q1);
+}
 
-    reorganize_byte_queues(temp);
-    
-    for(int i = MAX_QUEUE_COUNT - 1; i >= 0; i--)
+void Test_OutOfMemory()
+{
+    memory_pool pool;
+    Test_FillQueues(pool);
+    byte_queue* q1 = pool.get_queue(0);
+
+    pool.enqueue_byte(q1, 0x5);
+}
+
+void Test_OutOfMemory_2()
+{
+    memory_pool pool;
+    Test_FillQueues(pool);
+
+    // Program should shut down with "Program ran out of memory!" at this stage as there is no memory left in arena for 65th queue
+    byte_queue* invalidQueue = pool.create_queue();
+
+    pool.enqueue_byte(invalidQueue, 0x5);
+}
+
+void Test_Reallocate_Start()
+{
+    memory_pool pool;
+    byte_queue* q1 = pool.create_queue();
+    byte_queue* q2 = pool.create_queue();
+
+    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
     {
-        if(temp[i].bIs_Active == true)
-        {
-            byte_queue* it = std::find(std::begin(queues), std::end(queues), temp[i]);
-        
-            // Check if the element was found and calculate the index
-            if (it != std::end(temp))
-            {
-                return &queues[it - queues];
-            }
-        }
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q2, static_cast<unsigned char>(i));
     }
 
-    return nullptr;
+    pool.destroy_queue(q1);
+    byte_queue* q3 = pool.create_queue();
+    for(int i = DEFAULT_ALLOC_SIZE; i > 0; i--)
+    {
+        pool.enqueue_byte(q3, static_cast<unsigned char>(i));
+    }
 }
 
-/**
- * 
- * @param old_location Pointer to source
- * @param location Pointer to destination
- * @param size Size / count of moved elements
- * @param clear Previous memory location is erased after move if true, otherwise no actions are done to previous location
- */
-void relocate_bytes(unsigned char* old_location, unsigned char* location, unsigned int size, bool clear = false)
+void Test_Additional()
 {
-    if(location == old_location)
-        return;
+    memory_pool pool;
+    Test_FillQueues(pool);
 
-    std::memmove(location, old_location, size);
-    if(clear == true)
+    pool.destroy_queue(pool.get_queue(2), true);
+    pool.destroy_queue(pool.get_queue(3), true);
+    pool.destroy_queue(pool.get_queue(5), true);
+
+    byte_queue* first  = pool.create_queue();
+    byte_queue* second = pool.create_queue();
+    byte_queue* third  = pool.create_queue();
+
+    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
     {
-        for(unsigned int i = 0; i < size; i++)
-        {
-            old_location[i] = static_cast<unsigned char>(0x0);
-        }
+        pool.enqueue_byte(first, static_cast<unsigned char>(i));
+        pool.enqueue_byte(second, static_cast<unsigned char>(i));
+        pool.enqueue_byte(third, static_cast<unsigned char>(i));
     }
 }
 
-/**
- * 
- * @param ptr pointer to allocated memory block
- * @param allocSize size of allocated memory
- * @returns ptr to object if byte was added, otherwise nullptr
- */
-byte_queue* add_byte_queue(unsigned char* ptr, unsigned int allocSize)
+void Test_Organization()
 {
-    if(ptr == nullptr)
-        return nullptr;
+    memory_pool pool;
+    byte_queue* first  = pool.create_queue();
+    byte_queue* second = pool.create_queue();
+    byte_queue* third  = pool.create_queue();
+    byte_queue* fourth = pool.create_queue();
+    byte_queue* fifth  = pool.create_queue();
+    byte_queue* sixth  = pool.create_queue();
 
-    // Look for an inactive queue to reuse
-    for (auto& it : queues)
+    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
     {
-        if(!it.bIs_Active)
-        {
-            // Assign the memory to this queue
-            it.MemoryBlockPtr = ptr;
-            it.AllocatedSize = allocSize;
-            it.Size = 0;
-            it.bIs_Active = true; // Mark as active
-            return &it;
-        }
+        pool.enqueue_byte(first, static_cast<unsigned char>(i));
+        pool.enqueue_byte(second, static_cast<unsigned char>(i));
+        pool.enqueue_byte(third, static_cast<unsigned char>(i));
+        pool.enqueue_byte(fourth, static_cast<unsigned char>(i));
+        pool.enqueue_byte(fifth, static_cast<unsigned char>(i));
+        pool.enqueue_byte(sixth, static_cast<unsigned char>(i));
     }
 
-    // No inactive queue found, return nullptr
-    return nullptr;
+    pool.destroy_queue(first, true);
+    pool.destroy_queue(fifth, true);
+    pool.destroy_queue(fourth, true);
+    pool.try_organize_memory();
+
+    // Final result:
+    // second -> third -> sixth
+    // second has 32 Size (32 Alloc)  (Memory location = start of arena)
+    // third has 32 Size (32 Alloc)   (Memory location = second->MemoryBlockPtr + AllocSize)
+    // sixth has 32 Size (32 Alloc)   (Memory location = third->MemoryBlockPtr + AllocSize)
 }
 
-/** Goal of this function is to bunch all memory blocks together so there is no unused memory space between them
- * @return Returns true if memory was organized, false if memory couldn't be reorganized */
-bool try_organize_memory()
+// Slab allocator moves grown block to slab of another size class instead of growing it in place
+#if POOL_ALLOCATOR != ALLOCATOR_SLAB
+void Test_AddressOrder()
 {
-    // Eliminate unused queues between used ones
-    byte_queue temp[64];
-    std::copy(std::begin(queues), std::end(queues), std::begin(temp));
-    
-    reorganize_byte_queues(temp);
-    
-    int node_idx = 0;
-    bool memory_organized = false;
+    memory_pool pool;
+    byte_queue* q1 = pool.create_queue();
+    byte_queue* q2 = pool.create_queue();
+    byte_queue* q3 = pool.create_queue();
+    unsigned char* start = q1->MemoryBlockPtr;
+
+    // q1 grows in place over memory of q2, q4 reuses descriptor of q2 but its block is placed after q3
+    pool.destroy_queue(q2);
+    pool.resize_queue(q1, 2 * DEFAULT_ALLOC_SIZE);
+    byte_queue* q4 = pool.create_queue();
+    printf("%d\n", q4 == q2); // Expected output: 1
+
+    // Queues are linked in order of memory location, not in order of descriptors
+    for(byte_queue* queue = pool.get_first_queue(); queue != nullptr; queue = pool.get_next_queue(*queue))
+    {
+        printf("%d ", static_cast<int>(queue->MemoryBlockPtr - start));
+    }
+    printf("%d %d %d\n", q4->PreviousQueue, q3->NextQueue, pool.get_last_queue() == q4); // Expected output: 0 64 96 2 1 1
 
-    if(temp[node_idx].bIs_Active == false)
-        return false;
+    // Final result:
+    // q1 -> q3 -> q4
+    // q1 has 0 Size (64 Alloc), q3 has 0 Size (32 Alloc), q4 has 0 Size (32 Alloc)
+}
+#endif
 
-    byte_queue* previous = &temp[node_idx];
-    
-    if (previous->MemoryBlockPtr != data)
+#if POOL_ALLOCATOR == ALLOCATOR_FREE_GAP_INDEX
+void Test_BestFit()
+{
+    memory_pool pool;
+    byte_queue* queues[8];
+    for(int i = 0; i < 8; i++)
     {
-        relocate_bytes(previous->MemoryBlockPtr, data, previous->Size, true);
+        queues[i] = pool.create_queue();
+    }
+    unsigned char* start = queues[0]->MemoryBlockPtr;
 
-        byte_queue* it = std::find(std::begin(queues), std::end(queues), *previous);
-        
-        // Check if the element was found and calculate the index
-        if (it != std::end(temp))
-        {
-            queues[it - queues].MemoryBlockPtr = data;
-            memory_organized = true;
-        }
-        previous->MemoryBlockPtr = data;
+    // Gap of 3 granules at offset 32 comes first, gap of a single granule at offset 160 fits new queue exactly
+    for(int i = 1; i < 4; i++)
+    {
+        pool.destroy_queue(queues[i]);
     }
+    pool.destroy_queue(queues[5]);
 
-    node_idx++;
+    // q9 takes the exactly fitting gap, q10 takes the smaller of the two gaps left instead of free memory after q8
+    byte_queue* q9 = pool.create_queue();
+    byte_queue* q10 = pool.create_queue();
+    printf("%d %d\n", static_cast<int>(q9->MemoryBlockPtr - start), static_cast<int>(q10->MemoryBlockPtr - start)); // Expected output: 160 32
+
+    // Final result:
+    // q1 -> q10 -> q5 -> q9 -> q7 -> q8, every queue has 0 Size (32 Alloc)
+}
+#endif
 
-    while (node_idx < MAX_QUEUE_COUNT)
+void Test_RingBuffer()
+{
+    memory_pool pool;
+    byte_queue* q1 = pool.create_queue();
+    byte_queue* q2 = pool.create_queue();
+
+    // q1 wraps around the end of its 32 bytes block several times without being moved
+    for(int i = 1; i <= 100; i++)
     {
-        byte_queue* next = &temp[node_idx];
-        
-        if (next->bIs_Active)
-        {
-            unsigned char* start = previous->MemoryBlockPtr + previous->AllocatedSize;
-
-            if (start != next->MemoryBlockPtr)
-            {
-                // Reorganize / bunch up queues together to remove free space
-                relocate_bytes(next->MemoryBlockPtr, start, next->AllocatedSize);
-                byte_queue* it = std::find(std::begin(queues), std::end(queues), *next);
-        
-                // Check if the element was found and calculate the index
-                if (it != std::end(temp))
-                {
-                    queues[it - queues].MemoryBlockPtr = start;
-                    memory_organized = true;
-                }
-                next->MemoryBlockPtr = start;
-            }
-            previous = next;
-        }
-        
-        node_idx++;
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+        pool.dequeue_byte(q1);
+        pool.dequeue_byte(q1);
     }
-    
-    return memory_organized;
+
+    for(int i = 1; i <= 20; i++)
+    {
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+    }
+    for(int i = 1; i <= 10; i++)
+    {
+        pool.dequeue_byte(q1);
+    }
+
+    // q1 is wrapped at this point and grows - its contents are kept in FIFO order after relocation
+    for(int i = 21; i <= 40; i++)
+    {
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+    }
+
+    for(int i = 11; i <= 40; i++)
+    {
+        printf("%d ", pool.dequeue_byte(q1)); // Expected output: 11 12 ... 40
+    }
+    printf("\n");
+
+    // Final result:
+    // q2 -> q1
+    // q1 has 0 Size (32 Alloc)
+    // q2 has 0 Size (32 Alloc)
+    pool.destroy_queue(q2);
+    pool.destroy_queue(q1);
 }
 
-/**
- * Use only when creating new queue
- * @param requested_size Requested allocation size
- * @return Pointer to start of available memory block 
- */
-unsigned char* first_free_memory(unsigned int requested_size)
+void Test_BulkBytes()
 {
-    byte_queue* queue = get_first_queue();
-
-    if(queue == nullptr)
+    memory_pool pool;
+    unsigned char frame[100];
+    for(int i = 0; i < 100; i++)
     {
-        // return pointer to beginning of data
-        return data;
+        frame[i] = static_cast<unsigned char>(i);
     }
-    
-    // Check if the beginning of the memory is allocated
-    if(data != queue->MemoryBlockPtr)
+
+    byte_queue* q1 = pool.create_queue();
+    byte_queue* q2 = pool.create_queue();
+
+    // q1 is grown once to 128 bytes and relocated behind q2
+    pool.enqueue_bytes(q1, frame, 100);
+    pool.enqueue_byte(q2, 0x0);
+
+    unsigned char received[100];
+    pool.dequeue_bytes(q1, received, 60);
+    pool.enqueue_bytes(q1, frame, 60);
+    pool.dequeue_bytes(q1, received, 40);
+
+    for(int i = 0; i < 40; i++)
     {
-        // Check if there is enough space at the beginning of array
-        if(data + requested_size <= queue->MemoryBlockPtr)
-            return data;
+        printf("%d ", received[i]); // Expected output: 60 61 ... 99
+    }
+    printf("\n");
 
-        // return nullptr memory is organized and can't be organized anymore
-        if(try_organize_memory() == false)
-            return nullptr;
+    // Final result:
+    // q2 -> q1
+    // q1 has 60 Size (128 Alloc) - q1 didn't drop below low watermark of shrink policy
+    // q2 has 1 Size (32 Alloc)
+}
 
-        queue = get_last_queue();
-        unsigned char* mem_block_start = queue->MemoryBlockPtr + queue->AllocatedSize;
-        
-        if(mem_block_start + requested_size <= data + MEMORY_ALLOC_SIZE)
-            return mem_block_start;
+void Test_ReserveCommit()
+{
+    memory_pool pool;
+    byte_queue* q1 = pool.create_queue();
 
-        // There is not enough space to store the queue
-        return nullptr;
+    // Producer writes straight to the memory block of q1
+    unsigned char* target = pool.reserve(q1, 48);
+    for(int i = 0; i < 40; i++)
+    {
+        target[i] = static_cast<unsigned char>(i);
     }
+    pool.commit(q1, 40);
 
-    byte_queue* node = get_next_queue(*queue);
-    if(node == nullptr)
+    // Consumer reads bytes in place and releases only part of them
+    byte_span span = pool.peek(q1);
+    printf("%d %d\n", static_cast<int>(span.Size), span.Data[0]); // Expected output: 40 0
+    pool.consume(q1, 30);
+
+    // q1 was shrunk to 32 bytes by consume and is grown in place to 64 bytes to fit reserved space
+    target = pool.reserve(q1, 50);
+    for(int i = 0; i < 50; i++)
     {
-        return queue->MemoryBlockPtr + queue->AllocatedSize;
+        target[i] = static_cast<unsigned char>(40 + i);
     }
+    pool.commit(q1, 50);
 
-    byte_queue temp[64];
-    std::copy(std::begin(queues), std::end(queues), std::begin(temp));
-    reorganize_byte_queues(temp);
-    
-    // Look for gaps between active queues
-    for(int i = 1; i < MAX_QUEUE_COUNT; i++)
+    span = pool.peek(q1);
+    printf("%d %d\n", static_cast<int>(span.Size), span.Data[0]); // Expected output: 60 30
+
+    // Final result:
+    // q1 has 60 Size (64 Alloc)
+}
+
+// Buddy and slab allocators round blocks to their own sizes and place them by size, memory can't be organized with them
+#if POOL_ALLOCATOR != ALLOCATOR_BUDDY && POOL_ALLOCATOR != ALLOCATOR_SLAB
+void Test_GrowthPolicy()
+{
+    memory_pool pool;
+    byte_queue* q1 = pool.create_queue();
+    int growth_count = 0;
+
+    // Default policy doubles the block, q1 grows 32 -> 64 -> 128 -> 256 -> 512 -> 1024
+    for(int i = 1; i <= 1000; i++)
     {
-        if(temp[i].bIs_Active == false)
-            break;
+        pool_size lastSize = q1->AllocatedSize;
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
 
-        // Check for gaps that can fit the requested size
-        if(temp[i].MemoryBlockPtr - (queue->MemoryBlockPtr + queue->AllocatedSize) >= requested_size)
-        {
-            return queue->MemoryBlockPtr + queue->AllocatedSize;
-        }
+        if(q1->AllocatedSize != lastSize)
+            growth_count++;
+    }
+    printf("%d %d\n", growth_count, static_cast<int>(q1->AllocatedSize)); // Expected output: 5 1024
+
+    pool.destroy_queue(q1);
+
+    // Fixed step policy grows q1 by 32 bytes - 31 times for the same amount of bytes
+    growth_policy fixed_step = pool.get_queue_growth();
+    fixed_step.Mode = GROWTH_FIXED_STEP;
+    pool.set_queue_growth(fixed_step);
+    q1 = pool.create_queue();
+    growth_count = 0;
 
-        queue = &temp[i];
+    for(int i = 1; i <= 1000; i++)
+    {
+        pool_size lastSize = q1->AllocatedSize;
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+
+        if(q1->AllocatedSize != lastSize)
+            growth_count++;
     }
+    printf("%d %d\n", growth_count, static_cast<int>(q1->AllocatedSize)); // Expected output: 31 1024
+}
+#endif
 
-    // No gaps found, check end of memory block
-    byte_queue* last_queue = get_last_queue();
-    unsigned char* ptr_to_first = last_queue->MemoryBlockPtr + last_queue->AllocatedSize;
+// Slab allocator doesn't shrink blocks in place, class block holds its whole slot
+#if POOL_ALLOCATOR != ALLOCATOR_SLAB
+void Test_ShrinkPolicy()
+{
+    memory_pool pool;
+    byte_queue* q1 = pool.create_queue();
+    int resize_count = 0;
 
-    // Check if there is enough space at the end
-    if(ptr_to_first + requested_size <= data + MEMORY_ALLOC_SIZE)
+    for(int i = 1; i <= 33; i++)
     {
-        return ptr_to_first;
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
     }
 
-    // Try to reorganize memory one last time
-    if(!try_organize_memory())
+    // q1 holds 32 - 33 bytes, default policy keeps 64 bytes block as q1 never drops to 25% of it
+    for(int i = 0; i < 100; i++)
     {
-        return nullptr;
+        pool_size lastSize = q1->AllocatedSize;
+        pool.dequeue_byte(q1);
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+
+        if(q1->AllocatedSize != lastSize)
+            resize_count++;
     }
+    printf("%d %d\n", resize_count, static_cast<int>(q1->AllocatedSize)); // Expected output: 0 64
 
-    // Check end of memory block again after reorganization
-    last_queue = get_last_queue();
-    ptr_to_first = last_queue->MemoryBlockPtr + last_queue->AllocatedSize;
+    // Immediate policy shrinks q1 to 32 bytes on every dequeue and grows it back to 64 bytes on every enqueue
+    shrink_policy shrink = pool.get_queue_shrink();
+    shrink.Mode = SHRINK_IMMEDIATE;
+    pool.set_queue_shrink(shrink);
+    resize_count = 0;
 
-    if(ptr_to_first + requested_size <= data + MEMORY_ALLOC_SIZE)
+    for(int i = 0; i < 100; i++)
     {
-        return ptr_to_first;
+        pool.dequeue_byte(q1);
+        if(q1->AllocatedSize != 64)
+            resize_count++;
+
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+        if(q1->AllocatedSize != 32)
+            resize_count++;
     }
+    printf("%d %d\n", resize_count, static_cast<int>(q1->AllocatedSize)); // Expected output: 200 64
+
+    // Draining q1 with default policy releases half of its block at once - 1024 -> 512 -> 256 -> 128 -> 64 -> 32
+    shrink.Mode = SHRINK_WATERMARK;
+    pool.set_queue_shrink(shrink);
+    resize_count = 0;
 
-    return nullptr;
+    for(int i = 1; i <= 967; i++)
+    {
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+    }
+    for(int i = 1; i <= 1000; i++)
+    {
+        pool_size lastSize = q1->AllocatedSize;
+        pool.dequeue_byte(q1);
+
+        if(q1->AllocatedSize != lastSize)
+            resize_count++;
+    }
+    printf("%d %d\n", resize_count, static_cast<int>(q1->AllocatedSize)); // Expected output: 5 32
+
+    // Final result:
+    // q1 has 0 Size (32 Alloc)
 }
+#endif
 
-/**
- * Use only when reallocating already existing queue
- * @param queue Target queue
- * @param size Requested allocation size
- * @return Pointer to start of available memory block 
- */
-unsigned char* get_available_memory_start(byte_queue &queue, unsigned int size)
+void Test_SeparatePools()
 {
-    byte_queue* node = get_next_queue(queue);
+    // Small pool fits 8 queues of 32 bytes, default pool isn't affected by queues of the small pool
+    memory_pool pool;
+    memory_pool small_pool(256, 8);
 
-    if(node == nullptr)
-        return data;
-    
-    // Check if gap between queue and next allocated queue is enough to use current ptr instead of relocating
-    if(node != nullptr && node->MemoryBlockPtr - queue.MemoryBlockPtr >= size)
-        return queue.MemoryBlockPtr;
-
-    // Gap to the next queue isn't large enough, therefore the queue will be relocated to the end of the byte array
-    node = get_last_queue();
-    if(node == nullptr)
-        return data;
-    
-    unsigned char* memory_start = node->MemoryBlockPtr + node->AllocatedSize;
-    
-    
-    // check if resized memory would not exceed bounds of the byte array.
-    // data + MEMORY_ALLOC_SIZE = first memory block outside of bounds of the byte array
-    // if memory_start + size == data + MEMORY_ALLOC_SIZE -> queue is still in range, as it ends on the very end of the byte array
-    // if memory_start + size > data + MEMORY_ALLOC_SIZE -> queue is out of range
-    
-    if(memory_start + size > data + MEMORY_ALLOC_SIZE)
+    byte_queue* q1 = pool.create_queue();
+    for(int i = 0; i < 8; i++)
     {
-        // data would exceed allocated size of memory
-        if(try_organize_memory() == false)
-            on_out_of_memory();
-        
-        node = get_last_queue();
-        
-        memory_start = node->MemoryBlockPtr + node->AllocatedSize;
+        byte_queue* temp = small_pool.create_queue();
+        small_pool.enqueue_byte(temp, static_cast<unsigned char>(i));
+    }
+    pool.enqueue_byte(q1, 0x5);
 
-        // check if memory reorganization has solved the issue and there's enough space at the end of memory to fit the queue
-        if(memory_start + size > data + MEMORY_ALLOC_SIZE)
-            on_out_of_memory();
+    int small_count = 0;
+    for(byte_queue* queue = small_pool.get_first_queue(); queue != nullptr; queue = small_pool.get_next_queue(*queue))
+    {
+        small_count++;
     }
-    
-    return memory_start;
+    printf("%d %d\n", small_count, pool.dequeue_byte(q1)); // Expected output: 8 5
+
+    // Final result:
+    // small_pool has 8 queues with 1 Size (32 Alloc) each and no free memory left
+    // pool has q1 with 0 Size (32 Alloc)
 }
 
-/**
- * Reserves queue in queues array
- * @return Pointer to reserved item in queues array
- * @exception on_out_of_memory is called when allocating more than 64 queues 
- */
-byte_queue* create_queue()
+void Test_Handles()
 {
-    unsigned char* start = first_free_memory(DEFAULT_ALLOC_SIZE);
-    if(start == nullptr)
-        on_out_of_memory();
+    memory_pool pool;
+    queue_handle h1 = pool.create_queue_handle();
+    queue_handle h2 = pool.create_queue_handle();
+
+    // h1 grows to 64 bytes and is relocated behind h2, its descriptor stays first in descriptor table
+    for(int i = 1; i <= 40; i++)
+    {
+        pool.enqueue_byte(h1, static_cast<unsigned char>(i));
+    }
+    pool.enqueue_byte(h2, 0x5);
 
-    byte_queue* result = add_byte_queue(start, DEFAULT_ALLOC_SIZE);
-    if(result == nullptr)
-        on_out_of_memory();
+    // Descriptors are reordered by memory location, handles still refer to the same queues
+    pool.compact_descriptors();
+    printf("%d %d %d\n", pool.resolve(h2) == pool.get_queue(0), pool.dequeue_byte(h1), pool.dequeue_byte(h2)); // Expected output: 1 1 5
 
-    result->MemoryBlockPtr = start;
-    result->AllocatedSize = DEFAULT_ALLOC_SIZE;
-    result->Size = 0;
-    result->bIs_Active = true;
+    // Destroyed queue's handle is stale even after its slot is reused by a new queue
+    pool.destroy_queue(h2);
+    queue_handle h3 = pool.create_queue_handle();
+    printf("%d %d\n", h3.Slot == h2.Slot, pool.resolve(h2) == nullptr); // Expected output: 1 1
 
-    return result;
+    // Final result:
+    // h3 -> h1
+    // h1 has 39 Size (64 Alloc)
+    // h3 has 0 Size (32 Alloc)
 }
 
-/**
- * 
- * @param queue Target queue
- * @param clear Erases memory handled by queue if true, otherwise no action is done
- */
-void destroy_queue(byte_queue* queue, bool clear = false)
+void Test_ManyQueues()
 {
-    if(clear == true)
+    // Count of queues is limited only by size of arena - 1000 queues of 32 bytes fit 32000 bytes
+    memory_pool pool(32000);
+    byte_queue* queues[1000];
+
+    for(int i = 0; i < 1000; i++)
     {
-        for(unsigned int i = 0; i < queue->AllocatedSize; i++)
-        {
-            queue->MemoryBlockPtr[i] = 0x0;
-        }
+        queues[i] = pool.create_queue();
+        pool.enqueue_byte(queues[i], static_cast<unsigned char>(i));
     }
 
-    // mark queue as inactive, therefore its previous content can be overwritten
-    queue->MemoryBlockPtr = nullptr;
-    queue->AllocatedSize = 0;
-    queue->Size = 0;
-    queue->bIs_Active = false;
+    // Released descriptors are reused, descriptor table doesn't grow
+    for(int i = 0; i < 1000; i += 2)
+    {
+        pool.destroy_queue(queues[i]);
+        queues[i] = pool.create_queue();
+    }
+    printf("%d %d\n", pool.get_queue(999) != nullptr, pool.get_queue(1000) == nullptr); // Expected output: 1 1
+
+    // Final result:
+    // 1000 queues, odd ones have 1 Size (32 Alloc), even ones have 0 Size (32 Alloc)
 }
 
-/**
- * 
- * @param queue Target queue
- * @param byte Inserted byte
- * @exception on_out_of_memory is called if no memory space is available to enqueue new byte
- */
-void enqueue_byte(byte_queue *queue, unsigned char byte)
+void Test_ActiveQueues()
 {
-    // If queue doesn't have enough memory allocated
-    if(queue->Size + 1 > queue->AllocatedSize)
+    memory_pool pool(4096);
+    byte_queue* queues[100];
+
+    for(int i = 0; i < 100; i++)
     {
-        unsigned char* lastPosition = queue->MemoryBlockPtr;
+        queues[i] = pool.create_queue();
+    }
+    for(int i = 0; i < 100; i += 3)
+    {
+        pool.destroy_queue(queues[i]);
+    }
 
-        unsigned int lastSize = queue->AllocatedSize;
-        queue->AllocatedSize += DEFAULT_ALLOC_SIZE;
-        queue->MemoryBlockPtr = get_available_memory_start(*queue, queue->AllocatedSize);
+    // Empty queue releases its memory block with this policy, it stays active but isn't linked to other queues
+    shrink_policy shrink = pool.get_queue_shrink();
+    shrink.Mode = SHRINK_IMMEDIATE;
+    shrink.MinimumSize = 0;
+    pool.set_queue_shrink(shrink);
+    pool.enqueue_byte(queues[1], 0x5);
+    pool.dequeue_byte(queues[1]);
+
+    int active_count = 0;
+    for(byte_queue* queue = pool.get_first_active_queue(); queue != nullptr; queue = pool.get_next_active_queue(*queue))
+    {
+        active_count++;
+    }
 
-        relocate_bytes(lastPosition, queue->MemoryBlockPtr, lastSize, true);
+    int linked_count = 0;
+    for(byte_queue* queue = pool.get_first_queue(); queue != nullptr; queue = pool.get_next_queue(*queue))
+    {
+        linked_count++;
     }
+    printf("%d %d %d\n", pool.get_active_count(), active_count, linked_count); // Expected output: 66 66 65
 
-    queue->MemoryBlockPtr[queue->Size] = byte;
-    queue->Size++;
+    // Final result:
+    // 66 active queues, queues[1] has 0 Size (0 Alloc), others have 0 Size (32 Alloc)
 }
 
-/**
- * 
- * @param queue Target queue
- * @return Removes byte from queue using FIFO
- * @exception on_invalid_operation is called if queue size is equal to 0
- */
-unsigned char dequeue_byte(byte_queue* queue)
+#if POOL_ALLOCATOR != ALLOCATOR_BUDDY && POOL_ALLOCATOR != ALLOCATOR_SLAB
+// Pool with 16 bytes granule that grows blocks by fixed 16 bytes step and doesn't erase released bytes
+struct small_pool_config : default_pool_config
 {
-    if(queue->Size == 0)
-        on_illegal_operation();
+    enum : unsigned int { GRANULE_SIZE = 16, ARENA_SIZE = 256, MAX_QUEUES = 16 };
 
-    unsigned char removed_byte = queue->MemoryBlockPtr[0];
-    
-    for(unsigned int i = 0; i < queue->Size; i++)
+    static const bool clear_memory = false;
+
+    typedef fixed_step_growth<16> growth_type;
+};
+
+void Test_PoolConfig()
+{
+    basic_memory_pool<small_pool_config> pool;
+    byte_queue* q1 = pool.create_queue();
+    int growth_count = 0;
+
+    // q1 grows 16 -> 32 -> 48
+    for(int i = 1; i <= 40; i++)
     {
-        queue->MemoryBlockPtr[i] = queue->MemoryBlockPtr[i + 1];
+        pool_size lastSize = q1->AllocatedSize;
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+
+        if(q1->AllocatedSize != lastSize)
+            growth_count++;
     }
-    
-    queue->Size--;
-    queue->MemoryBlockPtr[queue->Size] = 0x0;
+    printf("%d %d\n", growth_count, static_cast<int>(q1->AllocatedSize)); // Expected output: 2 48
 
-    if(queue->Size <= queue->AllocatedSize - DEFAULT_ALLOC_SIZE)
-        queue->AllocatedSize -= DEFAULT_ALLOC_SIZE;
-    
-    return removed_byte;
+    // Dequeued byte stays in memory block as small_pool_config doesn't clear memory
+    pool.dequeue_byte(q1);
+    printf("%d\n", q1->MemoryBlockPtr[0]); // Expected output: 1
+
+    // Final result:
+    // q1 has 39 Size (48 Alloc)
 }
 
-void Test_SCSTest()
+struct compact_pool_config : default_pool_config
 {
-    byte_queue* q0 = create_queue();
-    enqueue_byte(q0, 0);  // Queue 0: [0]
-    enqueue_byte(q0, 1);  // Queue 0: [0, 1]
-    byte_queue* q1 = create_queue();
-    enqueue_byte(q1, 3);  // Queue 1: [3]
-    enqueue_byte(q0, 2);  // Queue 0: [0, 1, 2]
-    enqueue_byte(q1, 4);  // Queue 1: [3, 4]
-    printf("%d ", dequeue_byte(q0)); // Expected output: 0
-    printf("%d\n", dequeue_byte(q0)); // Expected output: 1
-    enqueue_byte(q0, 5);  // Queue 0: [2, 5]
-    enqueue_byte(q1, 6);  // Queue 1: [3, 4, 6]
-    printf("%d ", dequeue_byte(q0)); // Expected output: 2
-    printf("%d\n", dequeue_byte(q0)); // Expected output: 5
-    destroy_queue(q0); // Destroy queue 0
-    printf("%d ", dequeue_byte(q1)); // Expected output: 3
-    printf("%d ", dequeue_byte(q1)); // Expected output: 4
-    printf("%d\n", dequeue_byte(q1)); // Expected output: 6
-    destroy_queue(q1); // Destroy queue 1
-}
-
-void Test_FillQueues()
+    typedef compact_byte_queue descriptor_type;
+};
+
+void Test_CompactDescriptors()
 {
-    for(int i = 0; i < MAX_QUEUE_COUNT; i++)
-    {
-        byte_queue* temp = create_queue();
+    basic_memory_pool<compact_pool_config> pool;
+    compact_byte_queue* q1 = pool.create_queue();
+    compact_byte_queue* q2 = pool.create_queue();
+    compact_byte_queue* q3 = pool.create_queue();
 
-        for(int j = 1; j <= DEFAULT_ALLOC_SIZE; j++)
-        {
-            enqueue_byte(temp, static_cast<unsigned char>(j));
-        }
+    printf("%d %d\n", static_cast<int>(sizeof(byte_queue)), static_cast<int>(sizeof(compact_byte_queue))); // Expected output: 40 28 (48 28 with POOL_64BIT_SIZES)
+
+    // q1 has to move behind q3 when it grows, offset of its block changes with it
+    for(int i = 1; i <= 40; i++)
+    {
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
     }
+    pool.destroy_queue(q2);
+    pool.enqueue_byte(q3, 5);
+
+    byte_span span = pool.peek(q1);
+    printf("%d %d %d\n", q1->MemoryBlockOffset, span.Data[0], span.Data[39]); // Expected output: 96 1 40
+
+    // Final result:
+    // q1 has 40 Size (64 Alloc), q3 has 1 Size (32 Alloc)
 }
 
-void Test_Reallocation()
+void Test_GrowBackwards()
 {
-    byte_queue* q1 = create_queue();
-    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+    // Arena fits exactly 5 queues
+    memory_pool pool(160);
+    byte_queue* q1 = pool.create_queue();
+    byte_queue* q2 = pool.create_queue();
+    byte_queue* q3 = pool.create_queue();
+    byte_queue* q4 = pool.create_queue();
+    byte_queue* q5 = pool.create_queue();
+    unsigned char* start = q1->MemoryBlockPtr;
+    unsigned char* q4_block = q4->MemoryBlockPtr;
+    unsigned char* q5_block = q5->MemoryBlockPtr;
+
+    pool.destroy_queue(q1);
+    pool.destroy_queue(q3);
+
+    // 96 bytes fit only gaps before and after q2 together, q2 slides back to start of arena and memory isn't reorganized
+    unsigned char bytes[80];
+    for(int i = 0; i < 80; i++)
     {
-        enqueue_byte(q1, static_cast<unsigned char>(i));
+        bytes[i] = static_cast<unsigned char>(i + 1);
     }
+    pool.enqueue_bytes(q2, bytes, 80);
 
-    byte_queue* q2 = create_queue();
-    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+    printf("%d %d\n", q2->MemoryBlockPtr == start, static_cast<int>(q2->AllocatedSize)); // Expected output: 1 96
+    printf("%d %d\n", q4->MemoryBlockPtr == q4_block, q5->MemoryBlockPtr == q5_block); // Expected output: 1 1
+    printf("%d %d\n", pool.peek(q2).Data[0], pool.peek(q2).Data[79]); // Expected output: 1 80
+
+    // Final result:
+    // q2 has 80 Size (96 Alloc), q4 and q5 have 0 Size (32 Alloc)
+}
+
+void Test_QueueCapacity()
+{
+    memory_pool pool;
+    byte_queue* q1 = pool.create_queue();
+    byte_queue* q2 = pool.create_queue();
+
+    // Block is placed once for all bytes, enqueue doesn't move it anymore
+    pool.reserve_queue(q1, 200);
+    unsigned char* block = q1->MemoryBlockPtr;
+    for(int i = 1; i <= 100; i++)
     {
-        enqueue_byte(q2, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
     }
+    printf("%d %d\n", static_cast<int>(q1->AllocatedSize), q1->MemoryBlockPtr == block); // Expected output: 224 1
 
-    for(int i = 33; i <= DEFAULT_ALLOC_SIZE * 2; i++)
+    pool.shrink_to_fit(q1);
+    printf("%d\n", static_cast<int>(q1->AllocatedSize)); // Expected output: 128
+
+    pool.resize_queue(q1, 300);
+    pool.shrink_to_fit(q2);
+    printf("%d %d %d %d\n", static_cast<int>(q1->AllocatedSize), pool.peek(q1).Data[0], pool.peek(q1).Data[99], static_cast<int>(q2->AllocatedSize)); // Expected output: 320 1 100 0
+
+    // Final result:
+    // q1 has 100 Size (320 Alloc), q2 has 0 Size (0 Alloc)
+}
+
+// Creates six queues with a single byte each, byte of q1 is 1, byte of q2 is 2 and so on, returns start of memory block of q1
+template<typename Pool>
+unsigned char* Test_FillSingleByteQueues(Pool& pool, byte_queue* (&queues)[6])
+{
+    for(int i = 0; i < 6; i++)
     {
-        enqueue_byte(q1, static_cast<unsigned char>(i));
+        queues[i] = pool.create_queue();
+        pool.enqueue_byte(queues[i], static_cast<unsigned char>(i + 1));
     }
+
+    return queues[0]->MemoryBlockPtr;
 }
 
-void Test_Reallocation_2()
+// Destroys q1, q3 and q5, so q2, q4 and q6 are separated by gaps of 32 bytes
+template<typename Pool>
+void Test_DestroyEveryOtherQueue(Pool& pool, byte_queue* (&queues)[6])
 {
-    // ----------- 1. section -----------
-    // q1, q2 and q2 start with 32 elements each
-    byte_queue* q1 = create_queue();
-    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+    for(int i = 0; i < 6; i += 2)
     {
-        enqueue_byte(q1, static_cast<unsigned char>(i));
+        pool.destroy_queue(queues[i]);
     }
+}
 
-    byte_queue* q2 = create_queue();
-    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+void Test_RunCompaction()
+{
+    memory_pool pool;
+    byte_queue* queues[6];
+    unsigned char* start = Test_FillSingleByteQueues(pool, queues);
+
+    // Blocks of q3, q4 and q6 are left in two runs, each run is moved at once
+    pool.destroy_queue(queues[0]);
+    pool.destroy_queue(queues[1]);
+    pool.destroy_queue(queues[4]);
+    pool.try_organize_memory();
+
+    printf("%d %d %d\n", static_cast<int>(queues[2]->MemoryBlockPtr - start), static_cast<int>(queues[3]->MemoryBlockPtr - start),
+        static_cast<int>(queues[5]->MemoryBlockPtr - start)); // Expected output: 0 32 64
+    printf("%d %d %d\n", pool.peek(queues[2]).Data[0], pool.peek(queues[3]).Data[0], pool.peek(queues[5]).Data[0]); // Expected output: 3 4 6
+
+    // Final result:
+    // q3, q4 and q6 have 1 Size (32 Alloc) at start of arena
+}
+
+void Test_CompactStep()
+{
+    memory_pool pool;
+    byte_queue* queues[6];
+    unsigned char* start = Test_FillSingleByteQueues(pool, queues);
+
+    Test_DestroyEveryOtherQueue(pool, queues);
+
+    // The first step moves only q2, the second one continues at q4 and reaches the end of arena
+    bool finished = pool.compact_step(32);
+    printf("%d %d %d\n", finished, static_cast<int>(queues[1]->MemoryBlockPtr - start), static_cast<int>(queues[3]->MemoryBlockPtr - start)); // Expected output: 0 0 96
+
+    finished = pool.compact_step(1000);
+    printf("%d %d %d\n", finished, static_cast<int>(queues[3]->MemoryBlockPtr - start), static_cast<int>(queues[5]->MemoryBlockPtr - start)); // Expected output: 1 32 64
+    printf("%d %d %d\n", pool.peek(queues[1]).Data[0], pool.peek(queues[3]).Data[0], pool.peek(queues[5]).Data[0]); // Expected output: 2 4 6
+
+    // Organized memory has nothing to move, step without budget still passes all blocks
+    printf("%d\n", pool.compact_step(0)); // Expected output: 1
+
+    // Step moves q4, q6 doesn't fit the rest of budget, so step never moves more than max(budget, the first block)
+    pool.destroy_queue(queues[1]);
+    finished = pool.compact_step(48);
+    printf("%d %d %d ", finished, static_cast<int>(queues[3]->MemoryBlockPtr - start), static_cast<int>(queues[5]->MemoryBlockPtr - start));
+    printf("%d\n", pool.compact_step(48)); // Expected output: 0 0 64 1
+
+    // Final result:
+    // q4 and q6 have 1 Size (32 Alloc) at start of arena
+}
+
+struct background_pool_config : default_pool_config
+{
+    static const bool inline_compaction = false;
+};
+
+void Test_BackgroundCompaction()
+{
+    basic_memory_pool<background_pool_config> pool;
+    pool_compactor<basic_memory_pool<background_pool_config>> compactor(pool, 5, 64, std::chrono::milliseconds(1));
+    byte_queue* queues[6];
+    unsigned char* start;
     {
-        enqueue_byte(q2, static_cast<unsigned char>(i));
+        std::lock_guard<std::mutex> lock(compactor.get_mutex());
+        start = Test_FillSingleByteQueues(pool, queues);
+        Test_DestroyEveryOtherQueue(pool, queues);
+        printf("%u\n", pool.get_fragmentation()); // Expected output: 5
     }
 
-    byte_queue* q3 = create_queue();
-    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+    compactor.start();
+    for(int i = 0; i < 1000 && compactor.get_stats().PassCount == 0; i++)
     {
-        enqueue_byte(q3, static_cast<unsigned char>(i));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
+    compactor.stop();
 
-    // ----------- 2. section -----------
-    // q2 is destroyed to release memory
-    destroy_queue(q2);
+    compaction_stats stats = compactor.get_stats();
+    printf("%d %d\n", stats.PassCount > 0, stats.StepCount >= 2); // Expected output: 1 1
+    printf("%d %d %d\n", static_cast<int>(queues[1]->MemoryBlockPtr - start), static_cast<int>(queues[3]->MemoryBlockPtr - start), static_cast<int>(queues[5]->MemoryBlockPtr - start)); // Expected output: 0 32 64
+    printf("%u\n", pool.get_fragmentation()); // Expected output: 0
 
-    // ----------- 3. section -----------
-    // q1 allocates another 32 elements - this should test that q1 can be simply resized as there is 32 bytes free between q1 and q3
+    // Final result:
+    // q2, q4 and q6 were moved to start of arena by maintenance thread, two steps of 64 bytes at least
+}
 
-    for(int i = 33; i <= DEFAULT_ALLOC_SIZE * 2; i++)
+void Test_BackgroundCompactionBudget()
+{
+    basic_memory_pool<background_pool_config> pool;
+    pool_compactor<basic_memory_pool<background_pool_config>> compactor(pool, 5, 0, std::chrono::milliseconds(1));
+    byte_queue* queues[6];
+    unsigned char* start;
     {
-        enqueue_byte(q1, static_cast<unsigned char>(i));
+        std::lock_guard<std::mutex> lock(compactor.get_mutex());
+        start = Test_FillSingleByteQueues(pool, queues);
+        Test_DestroyEveryOtherQueue(pool, queues);
     }
 
-    // ----------- 4. section -----------
-    // remove 48 bytes from q1 to free some space between q1 and q3 - enough for q2 - q1 allocation size is lowered to 32 as 32 is enough to fit 16 bytes.
-    // therefore q1 won't occupy too much of memory as it doesn't need
-    for(int i = 1; i <= 48; i++)
+    // Step without budget moves a single block, so the pass takes one step for each of q2, q4 and q6
+    compactor.start();
+    for(int i = 0; i < 1000 && compactor.get_stats().PassCount == 0; i++)
     {
-        printf("Byte removed from q1: %d\n", dequeue_byte(q1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
+    compactor.stop();
 
-    // ----------- 5. section -----------
-    // create q2 and fill it with 32 bytes
-    q2 = create_queue();
-    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
-    {
-        enqueue_byte(q2, static_cast<unsigned char>(i));
-    }
+    compaction_stats stats = compactor.get_stats();
+    printf("%d %d\n", static_cast<int>(stats.PassCount), static_cast<int>(stats.StepCount)); // Expected output: 1 3
+    printf("%d %d %d\n", static_cast<int>(queues[1]->MemoryBlockPtr - start), static_cast<int>(queues[3]->MemoryBlockPtr - start), static_cast<int>(queues[5]->MemoryBlockPtr - start)); // Expected output: 0 32 64
 
     // Final result:
-    // q1 -> q2 -> q3
-    // q1 has 16 Size (32 Alloc)
-    // q2 has 32 Size (32 Alloc)
-    // q3 has 32 Size (32 Alloc)
+    // q2, q4 and q6 were moved to start of arena by maintenance thread, one block at a time
 }
 
-void Test_Reallocation_3()
+struct threshold_pool_config : default_pool_config
 {
-    // ----------- 1. section -----------
-    // start with q1, q2, q3, q4 with 32 elements. q5 will start with 33, therefore will be moved "Behind" q6 after adding 33rd character as 33 bytes can't fit to 32 bytes sized memory
-    
-    byte_queue* q1 = create_queue();
-    byte_queue* q2 = create_queue();
-    byte_queue* q3 = create_queue();
-    byte_queue* q4 = create_queue();
-    byte_queue* q5 = create_queue();
+    enum : unsigned int
+    {
+        COMPACTION_THRESHOLD = 25
+    };
+};
 
-    enqueue_byte(q5, 0x0);
-    
-    byte_queue* q6 = create_queue();
+struct manual_threshold_pool_config : threshold_pool_config
+{
+    static const bool inline_compaction = false;
+};
 
-    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+void Test_CompactionThreshold()
+{
+    // Arena fits 8 queues
+    basic_memory_pool<threshold_pool_config> pool(256);
+    byte_queue* queues[6];
+    unsigned char* start = Test_FillSingleByteQueues(pool, queues);
+
+    // Memory released at the end of arena joins the free memory after it, nothing is moved
+    pool.destroy_queue(queues[5]);
+    printf("%u %d\n", pool.get_fragmentation(), static_cast<int>(queues[1]->MemoryBlockPtr - start)); // Expected output: 0 32
+
+    // 32 of 128 free bytes are separated from the rest, which reaches the threshold
+    pool.destroy_queue(queues[0]);
+    printf("%u %d %d\n", pool.get_fragmentation(), static_cast<int>(queues[1]->MemoryBlockPtr - start), static_cast<int>(queues[4]->MemoryBlockPtr - start)); // Expected output: 0 0 96 (25 32 128 with ALLOCATOR_TLSF, which never organizes memory inline)
+    printf("%d %d\n", pool.peek(queues[1]).Data[0], pool.peek(queues[4]).Data[0]); // Expected output: 2 5
+
+    // Pool without inline compaction leaves released memory where it is, even above the threshold
+    basic_memory_pool<manual_threshold_pool_config> manual_pool(128);
+    byte_queue* manual_queues[3];
+    for(int i = 0; i < 3; i++)
     {
-        enqueue_byte(q1, static_cast<unsigned char>(i));
-        enqueue_byte(q2, static_cast<unsigned char>(i));
-        enqueue_byte(q3, static_cast<unsigned char>(i));
-        enqueue_byte(q4, static_cast<unsigned char>(i));
-        enqueue_byte(q5, static_cast<unsigned char>(i));
-        enqueue_byte(q6, static_cast<unsigned char>(i));
+        manual_queues[i] = manual_pool.create_queue();
     }
+    unsigned char* manual_start = manual_queues[0]->MemoryBlockPtr;
 
-    // ----------- 2. section -----------
-    // Destroy q3 and q4 to release memory
-    
-    destroy_queue(q3);
-    destroy_queue(q4);
+    manual_pool.destroy_queue(manual_queues[0]);
+    printf("%u %d\n", manual_pool.get_fragmentation(), static_cast<int>(manual_queues[1]->MemoryBlockPtr - manual_start)); // Expected output: 50 32
 
-    q3 = nullptr;
-    q4 = nullptr;
+    // Final result:
+    // q2 - q5 have 1 Size (32 Alloc) at start of arena, organized by destroy_queue instead of the next allocation
+    // q2 and q3 of manual_pool stay 32 bytes after start of its arena
+}
+#endif
 
-    // ----------- 3. section -----------
-    // create 4 new queues and fill them with 32 bytes
-    // q11, q12 and q13 will be placed between q2 and q6 (q5 was reallocated after q6, therefore there are 3 * 32 bytes free)
-    // q14 will be placed after q5 (because q5 is located after q6 due to its increased size to 64 bytes)
+typedef inline_queue<byte_queue, 16> small_queue;
 
-    byte_queue* q11 = create_queue();
-    byte_queue* q12 = create_queue();
-    byte_queue* q13 = create_queue();
-    byte_queue* q14 = create_queue();
-    
-    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+struct inline_pool_config : default_pool_config
+{
+    typedef small_queue descriptor_type;
+};
+
+void Test_InlineQueues()
+{
+    basic_memory_pool<inline_pool_config> pool;
+    small_queue* queues[100];
+
+    // Default arena fits only 64 memory blocks, queues of at most 16 bytes don't take any
+    for(int i = 0; i < 100; i++)
     {
-        enqueue_byte(q11, static_cast<unsigned char>(i));
-        enqueue_byte(q12, static_cast<unsigned char>(i));
-        enqueue_byte(q13, static_cast<unsigned char>(i));
-        enqueue_byte(q14, static_cast<unsigned char>(i));
+        queues[i] = pool.create_queue();
+        for(int j = 0; j < 10; j++)
+        {
+            pool.enqueue_byte(queues[i], static_cast<unsigned char>(j));
+        }
     }
-    
+    printf("%d %d\n", pool.get_active_count(), pool.get_first_queue() == nullptr); // Expected output: 100 1
+
+    // q1 gets memory block once its bytes don't fit inline storage
+    small_queue* q1 = queues[0];
+    for(int i = 10; i < 40; i++)
+    {
+        pool.enqueue_byte(q1, static_cast<unsigned char>(i));
+    }
+    printf("%d %d\n", q1->MemoryBlockPtr != nullptr, static_cast<int>(q1->AllocatedSize)); // Expected output: 1 64
+
+    // Block shrinks at low watermark and the remaining bytes fit inline storage again
+    for(int i = 0; i < 24; i++)
+    {
+        pool.dequeue_byte(q1);
+    }
+    printf("%d %d ", q1->MemoryBlockPtr == nullptr, static_cast<int>(q1->Size));
+    printf("%d\n", pool.dequeue_byte(q1)); // Expected output: 1 16 24
+
+    // Explicit sizes that fit inline storage keep bytes in descriptor, larger one takes memory block until it is resized back
+    pool.resize_queue(q1, 16);
+    pool.reserve_queue(queues[1], 12);
+    printf("%d %d ", q1->MemoryBlockPtr == nullptr, queues[1]->MemoryBlockPtr == nullptr);
+    pool.resize_queue(q1, 40);
+    pool.resize_queue(q1, 15);
+    printf("%d %d\n", q1->MemoryBlockPtr == nullptr, static_cast<int>(q1->AllocatedSize)); // Expected output: 1 1 1 16
+
     // Final result:
-    // q3 and q4 are NULL as they were destroyed. They no longer hold pointer to queues in array that are now used by other pointers
-    
-    // q1 -> q2 -> q11 -> q12 -> q13 -> q6 -> q5 -> q14
-    // q1 has 32 Size (32 Alloc)  (Memory Location = &data)
-    // q2 has 32 Size (32 Alloc)  (Memory Location = q1->MemoryBlockPtr + 32)
-    // q11 has 32 Size (32 Alloc) (Memory Location = q2->MemoryBlockPtr + 32)
-    // q12 has 32 Size (32 Alloc) (Memory Location = q11->MemoryBlockPtr + 32)
-    // q13 has 32 Size (32 Alloc) (Memory Location = q12->MemoryBlockPtr + 32)
-    // q6 has 32 Size (32 Alloc)  (Memory Location = q13->MemoryBlockPtr + 32)
-    // q5 has 33 Size (64 Alloc)  (Memory Location = q6->MemoryBlockPtr + 32)
-    // q14 has 32 Size (32 Alloc) (Memory Location = q5->MemoryBlockPtr + 64)
+    // q1 has 15 Size (16 inline), other 99 queues have 10 Size (16 inline), arena is empty
 }
 
-void Test_InvalidOperation()
+#if POOL_64BIT_SIZES
+void Test_LargeArena()
 {
-    byte_queue* q1 = create_queue();
-    dequeue_byte(q1);
-}
+    // Arena is mapped from the system, pages are backed by memory only where bytes are written
+    memory_pool pool(6ULL << 30);
+    byte_queue* q1 = pool.create_queue();
+    byte_queue* q2 = pool.create_queue();
 
-void Test_OutOfMemory()
-{
-    Test_FillQueues();
-    byte_queue* q1 = &queues[0];
+    // q1 gets memory block larger than 4 GB
+    unsigned char* bytes = pool.reserve(q1, 5ULL << 30);
+    bytes[0] = 1;
+    bytes[(5ULL << 30) - 1] = 2;
+    pool.commit(q1, 5ULL << 30);
+    pool.enqueue_byte(q2, 3);
+
+    printf("%llu %d\n", q1->Size >> 30, pool.peek(q1).Data[0]); // Expected output: 5 1
+    printf("%llu\n", pool.get_arena_size() - q1->AllocatedSize - q2->AllocatedSize); // Expected output: 1073741792
 
-    enqueue_byte(q1, 0x5);
+    // Final result:
+    // q1 has 5 GB Size (5 GB Alloc), q2 has 1 Size (32 Alloc)
 }
+#endif
 
-void Test_OutOfMemory_2()
+#if POOL_ALLOCATOR == ALLOCATOR_TLSF
+void Test_TlsfExactFit()
 {
-    Test_FillQueues();
+    memory_pool pool;
+    byte_queue* queues[64];
+    for(int i = 0; i < 64; i++)
+    {
+        queues[i] = pool.create_queue();
+    }
+    unsigned char* start = queues[0]->MemoryBlockPtr;
+
+    // Released queues merge to a single free block of 17 granules, which belongs to the list of 16 - 17 granules
+    for(int i = 10; i < 27; i++)
+    {
+        pool.destroy_queue(queues[i]);
+    }
 
-    // Program should shut down with "Program ran out of memory!" at this stage as we are trying to allocate space for 65th queue
-    byte_queue* invalidQueue = create_queue();
+    // Block of exactly requested size is found in its own list, rounded up request would look only at larger lists
+    unsigned char bytes[544] = {};
+    pool.enqueue_bytes(queues[0], bytes, 544);
+    printf("%d %d\n", static_cast<int>(queues[0]->MemoryBlockPtr - start), static_cast<int>(queues[0]->AllocatedSize)); // Expected output: 320 544
 
-    enqueue_byte(invalidQueue, 0x5);
+    // Final result:
+    // q1 has 544 Size (544 Alloc) at offset 320, memory wasn't organized
 }
+#endif
 
-void Test_Reallocate_Start()
+#if POOL_ALLOCATOR == ALLOCATOR_BITMAP
+void Test_BitmapRuns()
 {
-    byte_queue* q1 = create_queue();
-    byte_queue* q2 = create_queue();
+    // Arena of 1024 granules is tracked by 16 words, first 700 granules are used by one queue each
+    memory_pool pool(1024 * DEFAULT_ALLOC_SIZE);
+    std::vector<byte_queue*> queues;
+    for(int i = 0; i < 700; i++)
+    {
+        queues.push_back(pool.create_queue());
+    }
+    unsigned char* start = queues[0]->MemoryBlockPtr;
 
-    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+    // Free runs of 8 and 40 granules cross boundaries of words 1 / 2 and 9 / 10, 3 free granules follow q64 in word 1
+    for(int i = 126; i < 134; i++)
+    {
+        pool.destroy_queue(queues[i]);
+    }
+    for(int i = 620; i < 660; i++)
+    {
+        pool.destroy_queue(queues[i]);
+    }
+    for(int i = 64; i < 67; i++)
     {
-        enqueue_byte(q1, static_cast<unsigned char>(i));
-        enqueue_byte(q2, static_cast<unsigned char>(i));
+        pool.destroy_queue(queues[i]);
     }
 
-    destroy_queue(q1);
-    byte_queue* q3 = create_queue();
-    for(int i = DEFAULT_ALLOC_SIZE; i > 0; i--)
+    // q1 is moved to the first run that fits it, q2 skips fully used words 2 - 9 to reach the larger run
+    pool.resize_queue(queues[0], 8 * DEFAULT_ALLOC_SIZE);
+    pool.resize_queue(queues[1], 40 * DEFAULT_ALLOC_SIZE);
+    printf("%d %d\n", static_cast<int>((queues[0]->MemoryBlockPtr - start) / DEFAULT_ALLOC_SIZE), static_cast<int>((queues[1]->MemoryBlockPtr - start) / DEFAULT_ALLOC_SIZE)); // Expected output: 126 620
+
+    // q64 grows in place over the end of word 0 into free granules of word 1
+    pool.resize_queue(queues[63], 4 * DEFAULT_ALLOC_SIZE);
+    printf("%d %d\n", static_cast<int>((queues[63]->MemoryBlockPtr - start) / DEFAULT_ALLOC_SIZE), static_cast<int>(queues[63]->AllocatedSize)); // Expected output: 63 128
+
+    // Arena of 64 granules fits a single word, run of 3 granules is found after a run of a single granule
+    memory_pool small_pool;
+    byte_queue* small_queues[8];
+    for(int i = 0; i < 8; i++)
     {
-        enqueue_byte(q3, static_cast<unsigned char>(i));
+        small_queues[i] = small_pool.create_queue();
     }
+    unsigned char* small_start = small_queues[0]->MemoryBlockPtr;
+
+    small_pool.destroy_queue(small_queues[1]);
+    for(int i = 4; i < 7; i++)
+    {
+        small_pool.destroy_queue(small_queues[i]);
+    }
+    small_pool.resize_queue(small_queues[0], 3 * DEFAULT_ALLOC_SIZE);
+    printf("%d\n", static_cast<int>((small_queues[0]->MemoryBlockPtr - small_start) / DEFAULT_ALLOC_SIZE)); // Expected output: 4
+
+    // Final result:
+    // q1 has 256 Alloc at granule 126, q2 has 1280 Alloc at granule 620, q64 has 128 Alloc at granule 63
+    // q1 of small_pool has 96 Alloc at granule 4
 }
+#endif
 
-void Test_Additional()
+#if POOL_ALLOCATOR == ALLOCATOR_BUDDY
+void Test_BuddyBlocks()
 {
-    Test_FillQueues();
+    memory_pool pool;
+    byte_queue* queues[4];
+    for(int i = 0; i < 4; i++)
+    {
+        queues[i] = pool.create_queue();
+        pool.enqueue_byte(queues[i], static_cast<unsigned char>(i + 1));
+    }
+    unsigned char* start = queues[0]->MemoryBlockPtr;
 
-    destroy_queue(&queues[2], true);
-    destroy_queue(&queues[3], true);
-    destroy_queue(&queues[5], true);
+    // Arena is split down to 32 bytes blocks, first four queues take granules 0 - 3
+    printf("%d %d %d\n", static_cast<int>(queues[1]->MemoryBlockPtr - start), static_cast<int>(queues[2]->MemoryBlockPtr - start), static_cast<int>(queues[3]->MemoryBlockPtr - start)); // Expected output: 32 64 96
 
-    byte_queue* first  = create_queue();
-    byte_queue* second = create_queue();
-    byte_queue* third  = create_queue();
+    // q1 grows in place by absorbing its free buddy
+    pool.destroy_queue(queues[1]);
+    for(int i = 0; i < 40; i++)
+    {
+        pool.enqueue_byte(queues[0], static_cast<unsigned char>(i));
+    }
+    printf("%d %d\n", static_cast<int>(queues[0]->MemoryBlockPtr - start), static_cast<int>(queues[0]->AllocatedSize)); // Expected output: 0 64
 
-    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+    // Buddy of q3 is used by q4, so q3 is moved to a new 64 bytes block
+    for(int i = 0; i < 40; i++)
     {
-        enqueue_byte(first, static_cast<unsigned char>(i));
-        enqueue_byte(second, static_cast<unsigned char>(i));
-        enqueue_byte(third, static_cast<unsigned char>(i));
+        pool.enqueue_byte(queues[2], static_cast<unsigned char>(i));
     }
+    printf("%d %d %d\n", static_cast<int>(queues[2]->MemoryBlockPtr - start), static_cast<int>(queues[2]->AllocatedSize), pool.peek(queues[2]).Data[0]); // Expected output: 128 64 3
+
+    // Released buddies merge back, 128 bytes block fits start of arena again
+    pool.destroy_queue(queues[0]);
+    pool.destroy_queue(queues[3]);
+    byte_queue* q5 = pool.create_queue();
+    unsigned char bytes[128] = {};
+    pool.enqueue_bytes(q5, bytes, 128);
+    printf("%d %d\n", static_cast<int>(q5->MemoryBlockPtr - start), static_cast<int>(q5->AllocatedSize)); // Expected output: 0 128
+
+    // Final result:
+    // q3 has 41 Size (64 Alloc) at offset 128, q5 has 128 Size (128 Alloc) at start of arena
 }
+#endif
 
-void Test_Organization()
+// Slab allocator is selected by configuration of pool, so the test runs whatever POOL_ALLOCATOR is
+struct slab_pool_config : default_pool_config
 {
-    byte_queue* first  = create_queue();
-    byte_queue* second = create_queue();
-    byte_queue* third  = create_queue();
-    byte_queue* fourth = create_queue();
-    byte_queue* fifth  = create_queue();
-    byte_queue* sixth  = create_queue();
+    typedef slab_allocator placement_type;
+};
 
-    for(int i = 1; i <= DEFAULT_ALLOC_SIZE; i++)
+void Test_SlabOccupancy()
+{
+    basic_memory_pool<slab_pool_config> pool;
+    pool.create_queue();
+    byte_queue* q2 = pool.create_queue();
+    byte_queue* q3 = pool.create_queue();
+
+    // q1 stays in 32 bytes class, q2 moves from 32 bytes class to 64 bytes class, q3 grows past the largest class and takes whole slab
+    for(int i = 1; i <= 40; i++)
+    {
+        pool.enqueue_byte(q2, static_cast<unsigned char>(i));
+    }
+    for(int i = 1; i <= 200; i++)
     {
-        enqueue_byte(first, static_cast<unsigned char>(i));
-        enqueue_byte(second, static_cast<unsigned char>(i));
-        enqueue_byte(third, static_cast<unsigned char>(i));
-        enqueue_byte(fourth, static_cast<unsigned char>(i));
-        enqueue_byte(fifth, static_cast<unsigned char>(i));
-        enqueue_byte(sixth, static_cast<unsigned char>(i));
+        pool.enqueue_byte(q3, static_cast<unsigned char>(i));
     }
 
-    destroy_queue(first, true);
-    destroy_queue(fifth, true);
-    destroy_queue(fourth, true);
-    try_organize_memory();
+    pool.print_slab_occupancy();
 
     // Final result:
-    // second -> third -> sixth
-    // second has 32 Size (32 Alloc)  (Memory location = data)
-    // third has 32 Size (32 Alloc)   (Memory location = second->MemoryBlockPtr + AllocSize)
-    // sixth has 32 Size (32 Alloc)   (Memory location = third->MemoryBlockPtr + AllocSize)
+    // Class 32: 1 slabs, 1 / 8 blocks used (q1)
+    // Class 64: 1 slabs, 1 / 4 blocks used (q2)
+    // Class 128: 0 slabs, 0 / 0 blocks used
+    // Whole slabs: 1 slabs, 1 / 1 blocks used (q3)
 }
 
 int main(int argc, char* argv[])
@@ -1,10 +1,21 @@
 ﻿#pragma once
+#include "pool_size.h"
 
 typedef struct byte_queue
 {
+    // Count of bytes queue can store without memory block, see inline_queue
+    enum : unsigned int { INLINE_CAPACITY = 0 };
+
     unsigned char* MemoryBlockPtr = nullptr;
-    unsigned int AllocatedSize = 0;
-    unsigned int Size = 0;
+    pool_size AllocatedSize = 0;
+    pool_size Size = 0;
+    // Offset of the oldest byte inside the memory block, contents wrap around AllocatedSize
+    pool_size Head = 0;
+    // Indices of neighbouring queues in order of memory location, -1 if there is none
+    int PreviousQueue = -1;
+    int NextQueue = -1;
+    // Slot of handle table that refers to this queue
+    unsigned int Slot = 0xFFFFFFFF;
     bool bIs_Active = false;
 
     bool operator==(const byte_queue& queue) const
@@ -12,7 +23,40 @@ typedef struct byte_queue
         return (this->MemoryBlockPtr == queue.MemoryBlockPtr &&
                 this->AllocatedSize == queue.AllocatedSize &&
                 this->Size == queue.Size &&
+                this->Head == queue.Head &&
+                this->PreviousQueue == queue.PreviousQueue &&
+                this->NextQueue == queue.NextQueue &&
+                this->Slot == queue.Slot &&
                 this->bIs_Active == queue.bIs_Active);
     }
     
-} byt_queue;
\ No newline at end of file
+} byt_queue;
+
+// Descriptor access used by memory pool, so it can work with byte_queue and compact_byte_queue the same way
+
+/**
+ * 
+ * @param queue Target queue
+ * @return Pointer to memory block of queue, nullptr if queue has none
+ */
+inline unsigned char* get_memory_block(const byte_queue& queue, unsigned char*)
+{
+    return queue.MemoryBlockPtr;
+}
+
+inline void set_memory_block(byte_queue& queue, unsigned char* block, unsigned char*)
+{
+    queue.MemoryBlockPtr = block;
+}
+
+inline void set_active(byte_queue& queue, bool active)
+{
+    queue.bIs_Active = active;
+}
+
+typedef struct byte_span
+{
+    const unsigned char* Data = nullptr;
+    pool_size Size = 0;
+    
+} byt_span;
@@ -0,0 +1,165 @@
+﻿#pragma once
+#include <algorithm>
+#include "pool_size.h"
+
+// How memory block of a full queue is grown
+enum growth_mode
+{
+    GROWTH_FIXED_STEP,      // Block grows by Step bytes
+    GROWTH_GEOMETRIC,       // Block size is multiplied by Numerator / Denominator
+    GROWTH_CAPPED           // Block size is multiplied by Numerator / Denominator, but it grows by MaxStep bytes at most
+};
+
+typedef struct growth_policy
+{
+    growth_mode Mode = GROWTH_GEOMETRIC;
+    unsigned int Step = 32;
+    unsigned int Numerator = 2;
+    unsigned int Denominator = 1;
+    unsigned int MaxStep = 512;
+
+    /**
+     * 
+     * @return False if Denominator is 0, pool rejects such policy
+     */
+    bool is_valid() const
+    {
+        return Denominator > 0;
+    }
+
+    /**
+     * 
+     * @param allocated_size Current size of memory block
+     * @return Size of memory block based on Mode, before it is rounded by allocator
+     */
+    unsigned long long get_grown_size(pool_size allocated_size) const
+    {
+        if(Mode == GROWTH_FIXED_STEP)
+            return static_cast<unsigned long long>(allocated_size) + Step;
+
+        unsigned long long grownSize = static_cast<unsigned long long>(allocated_size) * Numerator / Denominator;
+
+        if(Mode == GROWTH_CAPPED && grownSize > static_cast<unsigned long long>(allocated_size) + MaxStep)
+            grownSize = static_cast<unsigned long long>(allocated_size) + MaxStep;
+
+        return grownSize;
+    }
+    
+} growth_policy;
+
+// When dequeue functions release memory of a queue that holds less bytes
+enum shrink_mode
+{
+    SHRINK_IMMEDIATE,       // Block shrinks as soon as contents fit a smaller block
+    SHRINK_WATERMARK,       // Block shrinks once Size drops to LowWatermark percent of it, new block is used to TargetUsage percent
+    SHRINK_NEVER            // Block keeps its size until queue is destroyed
+};
+
+typedef struct shrink_policy
+{
+    shrink_mode Mode = SHRINK_WATERMARK;
+    unsigned int LowWatermark = 25;
+    unsigned int TargetUsage = 50;
+    // Block never shrinks below this size, 0 releases block of an empty queue
+    unsigned int MinimumSize = 32;
+
+    /**
+     * 
+     * @return False if TargetUsage is 0 or LowWatermark isn't below it, pool rejects such policy
+     */
+    bool is_valid() const
+    {
+        return TargetUsage > 0 && LowWatermark < TargetUsage;
+    }
+
+    /**
+     * 
+     * @param size Count of bytes stored in queue
+     * @param allocated_size Current size of memory block
+     * @return Size of memory block based on Mode before it is rounded by allocator, allocated_size if block shouldn't shrink
+     */
+    unsigned long long get_shrunk_size(pool_size size, pool_size allocated_size) const
+    {
+        unsigned long long targetSize = size;
+
+        if(Mode == SHRINK_NEVER)
+            return allocated_size;
+
+        if(Mode == SHRINK_WATERMARK)
+        {
+            // Queue keeps its block until it drops below low watermark, so it doesn't shrink and grow again around one size
+            if(static_cast<unsigned long long>(size) * 100 > static_cast<unsigned long long>(allocated_size) * LowWatermark)
+                return allocated_size;
+
+            targetSize = static_cast<unsigned long long>(size) * 100 / TargetUsage;
+        }
+
+        return std::max<unsigned long long>(targetSize, MinimumSize);
+    }
+    
+} shrink_policy;
+
+// Policies fixed at compile time, they can be used by pool configuration instead of growth_policy / shrink_policy
+// so enqueue and dequeue functions don't check Mode at runtime
+
+template<unsigned int Step>
+struct fixed_step_growth
+{
+    bool is_valid() const
+    {
+        return true;
+    }
+
+    unsigned long long get_grown_size(pool_size allocated_size) const
+    {
+        return static_cast<unsigned long long>(allocated_size) + Step;
+    }
+};
+
+template<unsigned int Numerator, unsigned int Denominator = 1>
+struct geometric_growth
+{
+    static_assert(Denominator > 0, "Denominator of growth policy has to be larger than 0");
+
+    bool is_valid() const
+    {
+        return true;
+    }
+
+    unsigned long long get_grown_size(pool_size allocated_size) const
+    {
+        return static_cast<unsigned long long>(allocated_size) * Numerator / Denominator;
+    }
+};
+
+template<unsigned int LowWatermark, unsigned int TargetUsage, unsigned int MinimumSize>
+struct watermark_shrink
+{
+    static_assert(TargetUsage > 0 && LowWatermark < TargetUsage, "Low watermark of shrink policy has to be below its target usage");
+
+    bool is_valid() const
+    {
+        return true;
+    }
+
+    unsigned long long get_shrunk_size(pool_size size, pool_size allocated_size) const
+    {
+        if(static_cast<unsigned long long>(size) * 100 > static_cast<unsigned long long>(allocated_size) * LowWatermark)
+            return allocated_size;
+
+        return std::max<unsigned long long>(static_cast<unsigned long long>(size) * 100 / TargetUsage, MinimumSize);
+    }
+};
+
+struct no_shrink
+{
+    bool is_valid() const
+    {
+        return true;
+    }
+
+    unsigned long long get_shrunk_size(pool_size, pool_size allocated_size) const
+    {
+        return allocated_size;
+    }
+};
@@ -0,0 +1,55 @@
+﻿#pragma once
+
+/**
+ * Descriptor of queue that stores location of its memory block as offset from start of arena instead of pointer,
+ * it is 28 bytes large instead of 40 bytes of byte_queue on 64-bit platforms (48 bytes with POOL_64BIT_SIZES).
+ * Its sizes stay 32-bit in both cases, therefore arena can be 4 GB large at most
+ * Fields aren't packed below 32 bits, offset, sizes and Head each need the whole range of 4 GB arena
+ * and pool needs neighbour indices and handle slot of every queue
+ * Queue is active while it holds a slot of handle table, pool tracks active queues in its bitmaps
+ */
+typedef struct compact_byte_queue
+{
+    enum : unsigned int { NO_BLOCK = 0xFFFFFFFF, INLINE_CAPACITY = 0 };
+
+    // Offset of memory block from start of arena, NO_BLOCK if queue has no memory block
+    unsigned int MemoryBlockOffset = NO_BLOCK;
+    unsigned int AllocatedSize = 0;
+    unsigned int Size = 0;
+    // Offset of the oldest byte inside the memory block, contents wrap around AllocatedSize
+    unsigned int Head = 0;
+    // Indices of neighbouring queues in order of memory location, -1 if there is none
+    int PreviousQueue = -1;
+    int NextQueue = -1;
+    // Slot of handle table that refers to this queue
+    unsigned int Slot = 0xFFFFFFFF;
+
+    bool operator==(const compact_byte_queue& queue) const
+    {
+        return (this->MemoryBlockOffset == queue.MemoryBlockOffset &&
+                this->AllocatedSize == queue.AllocatedSize &&
+                this->Size == queue.Size &&
+                this->Head == queue.Head &&
+                this->PreviousQueue == queue.PreviousQueue &&
+                this->NextQueue == queue.NextQueue &&
+                this->Slot == queue.Slot);
+    }
+    
+} compact_byte_queue;
+
+static_assert(sizeof(compact_byte_queue) == 7 * sizeof(unsigned int), "Compact descriptor has to stay free of padding");
+
+inline unsigned char* get_memory_block(const compact_byte_queue& queue, unsigned char* arena)
+{
+    return queue.MemoryBlockOffset == compact_byte_queue::NO_BLOCK ? nullptr : arena + queue.MemoryBlockOffset;
+}
+
+inline void set_memory_block(compact_byte_queue& queue, unsigned char* block, unsigned char* arena)
+{
+    queue.MemoryBlockOffset = block == nullptr ? compact_byte_queue::NO_BLOCK : static_cast<unsigned int>(block - arena);
+}
+
+// Queue is active while it holds a slot of handle table, therefore active state isn't stored in descriptor
+inline void set_active(compact_byte_queue&, bool)
+{
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+#include "byte_queue.h"
+#include "compact_byte_queue.h"
+
+/**
+ * Descriptor with storage for up to Capacity bytes inside of it. Queue keeps its bytes in the descriptor without any memory block
+ * of arena until they don't fit anymore, then it is moved to arena like any other queue. Descriptor can be byte_queue or compact_byte_queue
+ */
+template<typename Descriptor, unsigned int Capacity>
+struct inline_queue : Descriptor
+{
+    static_assert(Capacity > 0, "Inline capacity of queue has to be larger than 0");
+
+    enum : unsigned int { INLINE_CAPACITY = Capacity };
+
+    unsigned char InlineBytes[Capacity];
+};
+
+/**
+ * 
+ * @param queue Target queue
+ * @return Inline storage of queue, nullptr if descriptor has none
+ */
+template<typename Descriptor, unsigned int Capacity>
+inline const unsigned char* get_inline_bytes(const inline_queue<Descriptor, Capacity>& queue)
+{
+    return queue.InlineBytes;
+}
+
+inline const unsigned char* get_inline_bytes(const byte_queue&)
+{
+    return nullptr;
+}
+
+inline const unsigned char* get_inline_bytes(const compact_byte_queue&)
+{
+    return nullptr;
+}
@@ -0,0 +1,13 @@
+﻿#pragma once
+
+// Sizes and offsets inside arena are 64-bit if POOL_64BIT_SIZES is 1, arena can be larger than 4 GB then
+// Allocators keep granule indices 32-bit, pool accepts arena of at most 2^31 - 1 granules
+#ifndef POOL_64BIT_SIZES
+#define POOL_64BIT_SIZES 0
+#endif
+
+#if POOL_64BIT_SIZES
+typedef unsigned long long pool_size;
+#else
+typedef unsigned int pool_size;
+#endif
@@ -0,0 +1,23 @@
+﻿#pragma once
+
+// Identifies queue of a pool, handle stays valid when descriptors of queues are moved and becomes stale once queue is destroyed
+typedef struct queue_handle
+{
+    unsigned int Slot = 0xFFFFFFFF;
+    unsigned int Generation = 0;
+
+    bool operator==(const queue_handle& handle) const
+    {
+        return (this->Slot == handle.Slot &&
+                this->Generation == handle.Generation);
+    }
+    
+} queue_handle;
+
+// Entry of handle table, Generation changes every time the slot is released
+typedef struct queue_slot
+{
+    unsigned int QueueIndex = 0xFFFFFFFF;
+    unsigned int Generation = 0;
+    
+} queue_slot;
@@ -0,0 +1,103 @@
+﻿#pragma once
+#include <vector>
+#include "../Model/pool_size.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+/**
+ * Arena stored in a vector, all of its bytes are zeroed when pool is created
+ */
+class heap_arena
+{
+public:
+    explicit heap_arena(pool_size size)
+        : bytes(static_cast<size_t>(size))
+    {
+    }
+
+    unsigned char* data()
+    {
+        return bytes.data();
+    }
+
+    const unsigned char* data() const
+    {
+        return bytes.data();
+    }
+
+    pool_size size() const
+    {
+        return static_cast<pool_size>(bytes.size());
+    }
+
+private:
+    std::vector<unsigned char> bytes;
+};
+
+/**
+ * Arena mapped directly from the system with mmap / VirtualAlloc. Pages are zeroed by the system and backed by physical memory
+ * only once they are touched, therefore arena of several gigabytes costs only memory that queues really use.
+ * On Windows whole arena is committed up front, so it still counts against system commit limit (RAM + page file) in full,
+ * pool writes anywhere in arena and pages aren't committed on demand. Other systems map it with MAP_NORESERVE without such charge
+ */
+class mapped_arena
+{
+public:
+    explicit mapped_arena(pool_size size)
+        : arena_size(size)
+    {
+        if(size == 0)
+            return;
+
+#if defined(_WIN32)
+        bytes = static_cast<unsigned char*>(VirtualAlloc(nullptr, static_cast<SIZE_T>(size), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+#else
+        void* memory = mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        bytes = memory == MAP_FAILED ? nullptr : static_cast<unsigned char*>(memory);
+#endif
+        // Pool checks data() after construction, so arena that couldn't be mapped has size 0
+        if(bytes == nullptr)
+            arena_size = 0;
+    }
+
+    ~mapped_arena()
+    {
+        if(bytes == nullptr)
+            return;
+
+#if defined(_WIN32)
+        VirtualFree(bytes, 0, MEM_RELEASE);
+#else
+        munmap(bytes, static_cast<size_t>(arena_size));
+#endif
+    }
+
+    mapped_arena(const mapped_arena&) = delete;
+    mapped_arena& operator=(const mapped_arena&) = delete;
+
+    unsigned char* data()
+    {
+        return bytes;
+    }
+
+    const unsigned char* data() const
+    {
+        return bytes;
+    }
+
+    pool_size size() const
+    {
+        return arena_size;
+    }
+
+private:
+    unsigned char* bytes = nullptr;
+    pool_size arena_size;
+};
@@ -0,0 +1,1572 @@
+﻿#pragma once
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <signal.h>
+#include <type_traits>
+#include <vector>
+#include "../Allocator/bit_operations.h"
+#include "../Model/byte_queue.h"
+#include "../Model/queue_handle.h"
+#include "pool_config.h"
+
+/**
+ * https://learn.microsoft.com/en-us/cpp/c-runtime-library/reference/signal?view=msvc-170
+ * Terminates program using signal call SIGABRT - Signal Abort - Abnormal termination
+ */
+inline void on_out_of_memory()
+{
+    std::cout << "Program ran out of memory!";
+    int _ = raise(SIGABRT);
+}
+
+/**
+ * https://learn.microsoft.com/en-us/cpp/c-runtime-library/reference/signal?view=msvc-170
+ * Terminates program using signal call SIGILL - Invalid instruction 
+ */
+inline void on_illegal_operation()
+{
+    std::cout << "Illegal operation recorded!";
+    int _ = raise(SIGILL);
+}
+
+/**
+ * Pool of byte queues. Pool owns its arena that memory blocks of queues are placed to and table of queue descriptors,
+ * therefore every pool can be used independently, e.g. by separate subsystem or thread
+ * @tparam Config Compile-time configuration of pool, see default_pool_config
+ */
+template<typename Config = default_pool_config>
+class basic_memory_pool
+{
+public:
+    typedef typename Config::placement_type placement_type;
+    typedef typename Config::descriptor_type queue_type;
+    // Type of AllocatedSize, Size and Head of descriptor, it is narrower than pool_size for compact_byte_queue with POOL_64BIT_SIZES
+    typedef decltype(queue_type::AllocatedSize) descriptor_size;
+
+    static_assert(Config::GRANULE_SIZE > 0, "Granule size of pool has to be larger than 0");
+
+    /**
+     * 
+     * @param arena_size Size of arena in bytes, multiple of Config::GRANULE_SIZE
+     * @param max_queue_count Count of queues that can be active at once, 0 if count of queues is limited only by memory
+     * @exception on_illegal_operation is called if descriptors or allocator can't address whole arena
+     * @exception on_out_of_memory is called if memory of arena can't be obtained
+     */
+    basic_memory_pool(pool_size arena_size = Config::ARENA_SIZE, unsigned int max_queue_count = Config::MAX_QUEUES)
+        : data(arena_size), max_queue_count(max_queue_count), allocator(arena_size, Config::GRANULE_SIZE)
+    {
+        // Allocators index granules with 32-bit values and compact descriptors store 32-bit offsets
+        if(arena_size / Config::GRANULE_SIZE >= 0x80000000ULL ||
+           arena_size > std::numeric_limits<descriptor_size>::max())
+            on_illegal_operation();
+
+        if(arena_size > 0 && data.data() == nullptr)
+            on_out_of_memory();
+    }
+
+    // Queues point to memory blocks inside arena of this pool, therefore pool can't be copied
+    basic_memory_pool(const basic_memory_pool&) = delete;
+    basic_memory_pool& operator=(const basic_memory_pool&) = delete;
+
+    /**
+     * Sets policy used by enqueue functions when queue runs out of allocated memory
+     * @param policy Growth policy of queues
+     * @exception on_illegal_operation is called if policy isn't valid, e.g. its Denominator is 0
+     */
+    void set_queue_growth(const typename Config::growth_type& policy)
+    {
+        if(policy.is_valid() == false)
+        {
+            on_illegal_operation();
+            return;
+        }
+
+        queue_growth = policy;
+    }
+
+    /**
+     * 
+     * @return Policy used by enqueue functions when queue runs out of allocated memory
+     */
+    const typename Config::growth_type& get_queue_growth() const
+    {
+        return queue_growth;
+    }
+
+    /**
+     * Sets policy used by dequeue functions when queue holds less bytes than its memory block can fit
+     * @param policy Shrink policy of queues
+     * @exception on_illegal_operation is called if policy isn't valid, e.g. its LowWatermark isn't below TargetUsage
+     */
+    void set_queue_shrink(const typename Config::shrink_type& policy)
+    {
+        if(policy.is_valid() == false)
+        {
+            on_illegal_operation();
+            return;
+        }
+
+        queue_shrink = policy;
+    }
+
+    /**
+     * 
+     * @return Policy used by dequeue functions when queue holds less bytes than its memory block can fit
+     */
+    const typename Config::shrink_type& get_queue_shrink() const
+    {
+        return queue_shrink;
+    }
+
+    /**
+     * Reserves queue in descriptor table of pool
+     * @return Pointer to reserved item in descriptor table
+     * @exception on_out_of_memory is called when there is no memory left for a queue or max_queue_count queues are active
+     */
+    queue_type* create_queue()
+    {
+        // Small queue keeps its bytes inside descriptor, memory block is taken once they don't fit there
+        if(queue_type::INLINE_CAPACITY > 0)
+        {
+            queue_type* result = add_byte_queue(nullptr, queue_type::INLINE_CAPACITY);
+            if(result == nullptr)
+                on_out_of_memory();
+
+            return result;
+        }
+
+        unsigned char* start = first_free_memory(Config::GRANULE_SIZE);
+        if(start == nullptr)
+            on_out_of_memory();
+
+        queue_type* result = add_byte_queue(start, Config::GRANULE_SIZE);
+        if(result == nullptr)
+            on_out_of_memory();
+
+        set_block(*result, start);
+        result->AllocatedSize = Config::GRANULE_SIZE;
+        result->Size = 0;
+        result->Head = 0;
+
+        return result;
+    }
+
+    /**
+     * 
+     * @param queue Target queue
+     * @param clear Erases memory handled by queue if true, otherwise no action is done
+     */
+    void destroy_queue(queue_type* queue, bool clear = false)
+    {
+        if(clear == true)
+        {
+            for(pool_size i = 0; i < queue->AllocatedSize; i++)
+            {
+                get_storage(*queue)[i] = 0x0;
+            }
+        }
+
+        if(get_block(*queue) != nullptr)
+        {
+            allocator.release(get_offset(get_block(*queue)), queue->AllocatedSize);
+            used_bytes -= queue->AllocatedSize;
+            unlink_queue(queue);
+            organize_released_memory();
+        }
+
+        // Inactive queue doesn't hold a slot of handle table
+        if(queue->Slot == NO_QUEUE)
+            return;
+
+        int queue_idx = get_index(*queue);
+        release_slot(queue);
+
+        // mark queue as inactive, therefore its previous content can be overwritten
+        set_block(*queue, nullptr);
+        queue->AllocatedSize = 0;
+        queue->Size = 0;
+        queue->Head = 0;
+        set_active(*queue, false);
+        descriptor_chunks[queue_idx / DESCRIPTOR_CHUNK_SIZE]->ActiveMask &= ~(1ULL << (queue_idx % DESCRIPTOR_CHUNK_SIZE));
+
+        // Inactive descriptors are linked together through NextQueue
+        queue->NextQueue = free_queue_idx;
+        free_queue_idx = queue_idx;
+    }
+
+    /**
+     * 
+     * @param queue Target queue
+     * @param byte Inserted byte
+     * @exception on_out_of_memory is called if no memory space is available to enqueue new byte
+     */
+    void enqueue_byte(queue_type *queue, unsigned char byte)
+    {
+        // If queue doesn't have enough memory allocated
+        if(queue->Size + 1 > queue->AllocatedSize)
+            grow_queue(queue, queue->Size + 1);
+
+        get_storage(*queue)[get_ring_index(*queue, queue->Size)] = byte;
+        queue->Size++;
+    }
+
+    /**
+     * 
+     * @param queue Target queue
+     * @return Removes byte from queue using FIFO
+     * @exception on_invalid_operation is called if queue size is equal to 0
+     */
+    unsigned char dequeue_byte(queue_type* queue)
+    {
+        if(queue->Size == 0)
+            on_illegal_operation();
+
+        unsigned char removed_byte = get_storage(*queue)[queue->Head];
+        if(Config::clear_memory)
+            get_storage(*queue)[queue->Head] = 0x0;
+
+        queue->Head = get_ring_index(*queue, 1);
+        queue->Size--;
+
+        if(queue->Size == 0)
+            queue->Head = 0;
+
+        shrink_queue(queue);
+    
+        return removed_byte;
+    }
+
+    /**
+     * Enqueues all bytes at once, memory block is grown at most once
+     * @param queue Target queue
+     * @param bytes Inserted bytes
+     * @param count Count of inserted bytes
+     * @exception on_out_of_memory is called if no memory space is available to enqueue all bytes
+     */
+    void enqueue_bytes(queue_type* queue, const unsigned char* bytes, pool_size count)
+    {
+        if(count == 0)
+            return;
+
+        grow_queue(queue, get_required_size(*queue, count));
+
+        // Free space of the ring can be split by the end of memory block, therefore copy is done in at most 2 parts
+        pool_size tail = get_ring_index(*queue, queue->Size);
+        pool_size first_part = std::min<pool_size>(count, queue->AllocatedSize - tail);
+
+        std::memcpy(get_storage(*queue) + tail, bytes, first_part);
+        std::memcpy(get_storage(*queue), bytes + first_part, count - first_part);
+
+        queue->Size += count;
+    }
+
+    /**
+     * Removes the oldest bytes from queue without copying them
+     * @param queue Target queue
+     * @param count Count of removed bytes
+     * @exception on_invalid_operation is called if queue holds less than count bytes
+     */
+    void consume(queue_type* queue, pool_size count)
+    {
+        if(count > queue->Size)
+            on_illegal_operation();
+
+        // Empty queue may have no storage at all, nothing is removed anyway
+        if(count == 0)
+            return;
+
+        pool_size first_part = std::min<pool_size>(count, queue->AllocatedSize - queue->Head);
+
+        if(Config::clear_memory)
+        {
+            std::memset(get_storage(*queue) + queue->Head, 0x0, first_part);
+            std::memset(get_storage(*queue), 0x0, count - first_part);
+        }
+
+        queue->Head = get_ring_index(*queue, count);
+        queue->Size -= count;
+
+        if(queue->Size == 0)
+            queue->Head = 0;
+
+        shrink_queue(queue);
+    }
+
+    /**
+     * Removes bytes from queue using FIFO
+     * @param queue Target queue
+     * @param bytes Destination of removed bytes
+     * @param count Count of removed bytes
+     * @exception on_invalid_operation is called if queue holds less than count bytes
+     */
+    void dequeue_bytes(queue_type* queue, unsigned char* bytes, pool_size count)
+    {
+        if(count > queue->Size)
+            on_illegal_operation();
+
+        if(count == 0)
+            return;
+
+        // Stored bytes can be split by the end of memory block, therefore copy is done in at most 2 parts
+        pool_size first_part = std::min<pool_size>(count, queue->AllocatedSize - queue->Head);
+
+        std::memcpy(bytes, get_storage(*queue) + queue->Head, first_part);
+        std::memcpy(bytes + first_part, get_storage(*queue), count - first_part);
+
+        consume(queue, count);
+    }
+
+    /**
+     * Reserves space for at least count bytes at the end of queue, written bytes are added to queue by commit
+     * Returned pointer is valid only until next operation that can move memory blocks (create_queue, enqueue, reserve, ...)
+     * @param queue Target queue
+     * @param count Count of bytes that will be written
+     * @return Pointer to count writable bytes located right after the last byte of queue
+     * @exception on_out_of_memory is called if no memory space is available to reserve requested bytes
+     */
+    unsigned char* reserve(queue_type* queue, pool_size count)
+    {
+        grow_queue(queue, get_required_size(*queue, count));
+
+        // Free space after the last byte is split when stored bytes don't wrap, rotate them back to start of the block in that case
+        if(get_writable_size(*queue) < count)
+            linearize_queue(queue);
+
+        return get_storage(*queue) + get_ring_index(*queue, queue->Size);
+    }
+
+    /**
+     * Adds bytes written to the space returned by reserve to queue
+     * @param queue Target queue
+     * @param count Count of written bytes
+     * @exception on_invalid_operation is called if count exceeds space returned by reserve
+     */
+    void commit(queue_type* queue, pool_size count)
+    {
+        if(count > get_writable_size(*queue))
+            on_illegal_operation();
+
+        queue->Size += count;
+    }
+
+    /**
+     * Stored bytes can be split by the end of memory block, returned span then ends at the end of the block
+     * and the rest of bytes is returned by next peek after consume
+     * @param queue Target queue
+     * @return Read-only span of the oldest bytes in queue, valid only until next operation that can move memory blocks
+     */
+    byte_span peek(const queue_type* queue) const
+    {
+        byte_span span;
+        span.Data = get_storage(*queue) + queue->Head;
+        span.Size = std::min(queue->Size, queue->AllocatedSize - queue->Head);
+        return span;
+    }
+
+    /**
+     * Grows memory block of queue so it can fit at least count bytes, block is placed at most once and contents are moved at most once
+     * Block can still be shrunk by queue_shrink once bytes are dequeued
+     * @param queue Target queue
+     * @param count Count of bytes queue has to fit
+     * @exception on_out_of_memory is called if no memory space is available for the block
+     */
+    void reserve_queue(queue_type* queue, pool_size count)
+    {
+        if(count <= queue->AllocatedSize)
+            return;
+
+        resize_queue(queue, count);
+    }
+
+    /**
+     * Sets size of memory block of queue to the smallest size allocator provides for count bytes, growth and shrink policies aren't used
+     * @param queue Target queue
+     * @param count Count of bytes queue has to fit
+     * @exception on_invalid_operation is called if queue holds more than count bytes
+     * @exception on_out_of_memory is called if no memory space is available for the block
+     */
+    void resize_queue(queue_type* queue, pool_size count)
+    {
+        if(count < queue->Size)
+            on_illegal_operation();
+
+        // Count that fits inline storage keeps bytes in descriptor, memory block isn't needed then
+        if(queue_type::INLINE_CAPACITY > 0 && count <= queue_type::INLINE_CAPACITY)
+        {
+            if(get_block(*queue) != nullptr)
+                move_to_inline_storage(queue);
+
+            return;
+        }
+
+        // Allocators round requested size up, size larger than arena could wrap around
+        if(count > data.size())
+            on_out_of_memory();
+
+        pool_size newSize = round_up_alloc_size(count);
+
+        if(newSize > queue->AllocatedSize)
+        {
+            unsigned char* newPosition = get_available_memory_start(*queue, newSize);
+            relocate_queue(queue, newPosition, newSize);
+        }
+        else if(newSize < queue->AllocatedSize && get_block(*queue) != nullptr)
+        {
+            shrink_block(queue, newSize);
+        }
+    }
+
+    /**
+     * Shrinks memory block of queue to the smallest size that fits its bytes, empty queue releases its block
+     * @param queue Target queue
+     */
+    void shrink_to_fit(queue_type* queue)
+    {
+        resize_queue(queue, queue->Size);
+    }
+
+    /** Goal of this function is to bunch all memory blocks together so there is no unused memory space between them
+     * @return Returns true if memory was organized, false if memory couldn't be reorganized */
+    bool try_organize_memory()
+    {
+        // Allocator places memory blocks at locations it depends on, they can't be moved
+        if(Config::compaction == false || placement_type::supports_compaction == false)
+            return false;
+
+        bool memory_organized = false;
+        unsigned char* start = data.data();
+        queue_type* queue = get_first_queue();
+        auto location = queue_locations.begin();
+
+        // Queues are moved in order of memory location, therefore each block is moved only towards start of arena
+        while(queue != nullptr)
+        {
+            unsigned char* run_start = get_block(*queue);
+            pool_size run_size = 0;
+
+            // Blocks right next to each other form a run, descriptors of the run are updated and the run is moved by a single memmove
+            do
+            {
+                // queue_locations follows the same order, key of moved block is replaced right at its position
+                auto next_location = std::next(location);
+                if(run_start != start)
+                {
+                    queue_locations.erase(location);
+                    queue_locations.emplace_hint(next_location, start + run_size, get_index(*queue));
+                }
+                location = next_location;
+
+                set_block(*queue, start + run_size);
+                run_size += queue->AllocatedSize;
+                queue = get_next_queue(*queue);
+            }
+            while(queue != nullptr && get_block(*queue) == run_start + run_size);
+
+            if(run_start != start)
+            {
+                // Whole blocks are moved so wrapped contents keep their Head offset
+                relocate_bytes(run_start, start, run_size, Config::clear_memory);
+                memory_organized = true;
+            }
+
+            start += run_size;
+        }
+
+        if(memory_organized == false)
+            return false;
+
+        // All memory blocks are located at start of arena and the rest of it is a single gap
+        allocator.reset();
+        if(placement_type::tracks_blocks == false)
+        {
+            allocator.claim(0, get_offset(start));
+            return true;
+        }
+
+        // Each block is claimed from the start of remaining free memory
+        for(queue_type* queue = get_first_queue(); queue != nullptr; queue = get_next_queue(*queue))
+        {
+            allocator.claim(get_offset(get_block(*queue)), queue->AllocatedSize);
+        }
+
+        return true;
+    }
+
+    /**
+     * Moves memory blocks after compaction cursor to free memory right before them until budget is used, cursor is kept between calls
+     * so memory is organized in small steps. Memory is fully organized once cursor passes the last block
+     * @param budget Count of bytes that can be moved, block that is larger than budget is moved if it is the first one,
+     * therefore step moves at most max(budget, size of the largest block) bytes
+     * @return true if cursor passed the last block and next step starts at start of arena, otherwise false
+     */
+    bool compact_step(pool_size budget)
+    {
+        // Allocator places memory blocks at locations it depends on, they can't be moved
+        if(Config::compaction == false || placement_type::supports_compaction == false)
+            return true;
+
+        pool_size moved = 0;
+        auto it = queue_locations.lower_bound(data.data() + compaction_cursor);
+
+        while(it != queue_locations.end())
+        {
+            queue_type* queue = &get_descriptor(it->second);
+            pool_size gap = allocator.gap_before(get_offset(get_block(*queue)));
+
+            // The first moved block is moved whatever its size, so every step makes progress even with budget of 0,
+            // following blocks are moved only while they fit the rest of budget
+            if(gap > 0 && moved > 0 && moved + queue->AllocatedSize > budget)
+            {
+                compaction_cursor = get_offset(it->first);
+                return false;
+            }
+
+            it = std::next(it);
+            if(gap > 0)
+            {
+                slide_queue(queue, get_block(*queue) - gap, it);
+                moved += queue->AllocatedSize;
+            }
+        }
+
+        compaction_cursor = 0;
+        return true;
+    }
+
+    /**
+     * 
+     * @return First active queue, nullptr if none is active
+     */
+    queue_type* get_first_queue()
+    {
+        return first_queue_idx == -1 ? nullptr : &get_descriptor(first_queue_idx);
+    }
+
+    /**
+     * 
+     * @param queue Target queue
+     * @return First active queue located after given queue, nullptr if none other is active
+     */
+    queue_type* get_next_queue(const queue_type& queue)
+    {
+        return queue.NextQueue == -1 ? nullptr : &get_descriptor(queue.NextQueue);
+    }
+
+    /**
+     * 
+     * @return Last active queue, nullptr if none is active
+     */
+    queue_type* get_last_queue()
+    {
+        return last_queue_idx == -1 ? nullptr : &get_descriptor(last_queue_idx);
+    }
+
+    /**
+     * 
+     * @param index Index of queue in descriptor table
+     * @return Queue stored at index, nullptr if index is out of range
+     */
+    queue_type* get_queue(unsigned int index)
+    {
+        return index < descriptor_count ? &get_descriptor(index) : nullptr;
+    }
+
+    /**
+     * 
+     * @return Count of active queues, including queues without memory block
+     */
+    unsigned int get_active_count() const
+    {
+        unsigned int count = 0;
+        for(const auto& chunk : descriptor_chunks)
+        {
+            count += population_count(chunk->ActiveMask);
+        }
+
+        return count;
+    }
+
+    /**
+     * Active queues are walked in order of descriptor table, unlike get_first_queue it includes queues without memory block
+     * @return First active queue, nullptr if none is active
+     */
+    queue_type* get_first_active_queue()
+    {
+        int queue_idx = find_active_descriptor(0);
+        return queue_idx == -1 ? nullptr : &get_descriptor(queue_idx);
+    }
+
+    /**
+     * 
+     * @param queue Active queue
+     * @return Active queue that follows given queue in descriptor table, nullptr if there is none
+     */
+    queue_type* get_next_active_queue(const queue_type& queue)
+    {
+        int queue_idx = find_active_descriptor(static_cast<unsigned int>(get_index(queue)) + 1);
+        return queue_idx == -1 ? nullptr : &get_descriptor(queue_idx);
+    }
+
+    /**
+     * Reserves queue in descriptor table of pool
+     * @return Handle of reserved queue, it stays valid until the queue is destroyed
+     * @exception on_out_of_memory is called when there is no memory left for a queue or max_queue_count queues are active
+     */
+    queue_handle create_queue_handle()
+    {
+        return get_handle(create_queue());
+    }
+
+    /**
+     * 
+     * @param queue Active queue of this pool
+     * @return Handle that refers to the queue
+     */
+    queue_handle get_handle(const queue_type* queue) const
+    {
+        queue_handle handle;
+        handle.Slot = queue->Slot;
+        handle.Generation = slots[queue->Slot].Generation;
+        return handle;
+    }
+
+    /**
+     * 
+     * @param handle Handle of queue
+     * @return Queue the handle refers to, nullptr if the handle is stale - its queue was destroyed
+     */
+    queue_type* resolve(queue_handle handle)
+    {
+        if(handle.Slot >= slots.size() || slots[handle.Slot].Generation != handle.Generation || slots[handle.Slot].QueueIndex == NO_QUEUE)
+            return nullptr;
+
+        return &get_descriptor(slots[handle.Slot].QueueIndex);
+    }
+
+    void destroy_queue(queue_handle handle, bool clear = false)
+    {
+        destroy_queue(get_handle_queue(handle), clear);
+    }
+
+    void enqueue_byte(queue_handle handle, unsigned char byte)
+    {
+        enqueue_byte(get_handle_queue(handle), byte);
+    }
+
+    unsigned char dequeue_byte(queue_handle handle)
+    {
+        return dequeue_byte(get_handle_queue(handle));
+    }
+
+    void enqueue_bytes(queue_handle handle, const unsigned char* bytes, pool_size count)
+    {
+        enqueue_bytes(get_handle_queue(handle), bytes, count);
+    }
+
+    void dequeue_bytes(queue_handle handle, unsigned char* bytes, pool_size count)
+    {
+        dequeue_bytes(get_handle_queue(handle), bytes, count);
+    }
+
+    void consume(queue_handle handle, pool_size count)
+    {
+        consume(get_handle_queue(handle), count);
+    }
+
+    unsigned char* reserve(queue_handle handle, pool_size count)
+    {
+        return reserve(get_handle_queue(handle), count);
+    }
+
+    void commit(queue_handle handle, pool_size count)
+    {
+        commit(get_handle_queue(handle), count);
+    }
+
+    byte_span peek(queue_handle handle)
+    {
+        return peek(get_handle_queue(handle));
+    }
+
+    void reserve_queue(queue_handle handle, pool_size count)
+    {
+        reserve_queue(get_handle_queue(handle), count);
+    }
+
+    void resize_queue(queue_handle handle, pool_size count)
+    {
+        resize_queue(get_handle_queue(handle), count);
+    }
+
+    void shrink_to_fit(queue_handle handle)
+    {
+        shrink_to_fit(get_handle_queue(handle));
+    }
+
+    /**
+     * Moves descriptors of active queues to the start of descriptor table in order of memory location of their blocks,
+     * so walking queues in memory order reads descriptor table sequentially. Inactive descriptors are released
+     * Handles stay valid, pointers to queues returned by create_queue / resolve are invalidated
+     */
+    void compact_descriptors()
+    {
+        std::vector<int> new_index(descriptor_count, -1);
+        unsigned int count = 0;
+
+        // Linked queues go first in order of memory location, active queues without memory block follow
+        for(queue_type* queue = get_first_queue(); queue != nullptr; queue = get_next_queue(*queue))
+        {
+            new_index[get_index(*queue)] = static_cast<int>(count++);
+        }
+        for(int i = find_active_descriptor(0); i != -1; i = find_active_descriptor(i + 1))
+        {
+            if(new_index[i] == -1)
+                new_index[i] = static_cast<int>(count++);
+        }
+
+        std::vector<std::unique_ptr<descriptor_chunk>> moved((count + DESCRIPTOR_CHUNK_SIZE - 1) / DESCRIPTOR_CHUNK_SIZE);
+        for(auto& chunk : moved)
+        {
+            chunk.reset(new descriptor_chunk());
+        }
+
+        // Active queues fill the table from its start
+        for(unsigned int i = 0; i < count; i++)
+        {
+            moved[i / DESCRIPTOR_CHUNK_SIZE]->ActiveMask |= 1ULL << (i % DESCRIPTOR_CHUNK_SIZE);
+        }
+
+        for(int i = find_active_descriptor(0); i != -1; i = find_active_descriptor(i + 1))
+        {
+            queue_type& queue = moved[new_index[i] / DESCRIPTOR_CHUNK_SIZE]->Queues[new_index[i] % DESCRIPTOR_CHUNK_SIZE];
+            queue = get_descriptor(i);
+            queue.PreviousQueue = queue.PreviousQueue == -1 ? -1 : new_index[queue.PreviousQueue];
+            queue.NextQueue = queue.NextQueue == -1 ? -1 : new_index[queue.NextQueue];
+            slots[queue.Slot].QueueIndex = static_cast<unsigned int>(new_index[i]);
+        }
+
+        first_queue_idx = first_queue_idx == -1 ? -1 : new_index[first_queue_idx];
+        last_queue_idx = last_queue_idx == -1 ? -1 : new_index[last_queue_idx];
+
+        for(auto& location : queue_locations)
+        {
+            location.second = new_index[location.second];
+        }
+
+        descriptor_chunks.swap(moved);
+        descriptor_count = count;
+        free_queue_idx = -1;
+    }
+
+    /**
+     * 
+     * @return Size of arena in bytes
+     */
+    pool_size get_arena_size() const
+    {
+        return data.size();
+    }
+
+    /**
+     * 
+     * @return Percentage of free memory outside of the largest gap, 0 if free memory is a single gap or there is none
+     */
+    unsigned int get_fragmentation()
+    {
+        pool_size free_bytes = data.size() - used_bytes;
+        if(free_bytes == 0)
+            return 0;
+
+        return static_cast<unsigned int>(100 - static_cast<unsigned long long>(allocator.largest_gap()) * 100 / free_bytes);
+    }
+
+    /**
+     * 
+     * @param size Requested size
+     * @return Size of memory block allocator assigns for requested size, multiple of Config::GRANULE_SIZE
+     */
+    pool_size round_up_alloc_size(pool_size size)
+    {
+        return allocator.round_size(size);
+    }
+
+    /**
+     * Prints count of slabs and used / total blocks of each size class, available only if Config::placement_type is slab_allocator
+     */
+    template<typename Placement = placement_type>
+    typename std::enable_if<std::is_same<Placement, slab_allocator>::value>::type print_slab_occupancy()
+    {
+        for(unsigned int i = 0; i <= slab_allocator::CLASS_COUNT; i++)
+        {
+            slab_occupancy occupancy = allocator.get_occupancy(i);
+
+            if(i < slab_allocator::CLASS_COUNT)
+                printf("Class %u: ", static_cast<unsigned int>(occupancy.BlockSize));
+            else
+                printf("Whole slabs: ");
+
+            printf("%u slabs, %u / %u blocks used\n", occupancy.SlabCount, occupancy.UsedBlocks, occupancy.TotalBlocks);
+        }
+    }
+
+private:
+    /**
+     * 
+     * @param ptr Pointer inside arena
+     * @return Offset of pointer from start of arena
+     */
+    pool_size get_offset(const unsigned char* ptr)
+    {
+        return static_cast<pool_size>(ptr - data.data());
+    }
+
+    /**
+     * Narrows size or offset inside arena to size fields of descriptor, compact_byte_queue keeps them 32-bit with POOL_64BIT_SIZES
+     * @param value Size or offset inside arena
+     * @return Value in type of descriptor size fields
+     * @exception on_illegal_operation is called if value doesn't fit, constructor rejects arena that descriptor can't address
+     */
+    static descriptor_size to_descriptor_size(pool_size value)
+    {
+        // Compared as 64-bit values, so the check is valid whether descriptor fields are narrower than pool_size or not
+        if(static_cast<unsigned long long>(value) > static_cast<unsigned long long>(std::numeric_limits<descriptor_size>::max()))
+            on_illegal_operation();
+
+        return static_cast<descriptor_size>(value);
+    }
+
+    /**
+     * 
+     * @param queue Target queue
+     * @return Pointer to memory block of queue, nullptr if queue has none
+     */
+    unsigned char* get_block(const queue_type& queue) const
+    {
+        return get_memory_block(queue, const_cast<unsigned char*>(data.data()));
+    }
+
+    void set_block(queue_type& queue, unsigned char* block)
+    {
+        set_memory_block(queue, block, data.data());
+    }
+
+    /**
+     * 
+     * @param queue Target queue
+     * @return Memory block of queue, its inline storage if it has no memory block
+     */
+    unsigned char* get_storage(const queue_type& queue) const
+    {
+        unsigned char* block = get_block(queue);
+        return block != nullptr ? block : const_cast<unsigned char*>(get_inline_bytes(queue));
+    }
+
+    /**
+     * Inserts queue to the address ordered list of queues based on its memory location, its memory block has to be claimed from allocator
+     * @param queue Target queue, its memory block has to be assigned already
+     */
+    void link_queue(queue_type* queue)
+    {
+        int queue_idx = get_index(*queue);
+        auto it = queue_locations.emplace(get_block(*queue), queue_idx).first;
+
+        queue->PreviousQueue = it == queue_locations.begin() ? -1 : std::prev(it)->second;
+        queue->NextQueue = std::next(it) == queue_locations.end() ? -1 : std::next(it)->second;
+
+        if(queue->PreviousQueue == -1)
+            first_queue_idx = queue_idx;
+        else
+            get_descriptor(queue->PreviousQueue).NextQueue = queue_idx;
+
+        if(queue->NextQueue == -1)
+            last_queue_idx = queue_idx;
+        else
+            get_descriptor(queue->NextQueue).PreviousQueue = queue_idx;
+    }
+
+    /**
+     * Removes queue from the address ordered list of queues, its memory block has to be released from allocator separately
+     * @param queue Target queue
+     */
+    void unlink_queue(queue_type* queue)
+    {
+        queue_locations.erase(get_block(*queue));
+
+        if(queue->PreviousQueue == -1)
+            first_queue_idx = queue->NextQueue;
+        else
+            get_descriptor(queue->PreviousQueue).NextQueue = queue->NextQueue;
+
+        if(queue->NextQueue == -1)
+            last_queue_idx = queue->PreviousQueue;
+        else
+            get_descriptor(queue->NextQueue).PreviousQueue = queue->PreviousQueue;
+
+        queue->PreviousQueue = -1;
+        queue->NextQueue = -1;
+    }
+
+    /**
+     * 
+     * @param old_location Pointer to source
+     * @param location Pointer to destination
+     * @param size Size / count of moved elements
+     * @param clear Previous memory location is erased after move if true, otherwise no actions are done to previous location
+     */
+    static void relocate_bytes(unsigned char* old_location, unsigned char* location, pool_size size, bool clear = false)
+    {
+        if(location == old_location)
+            return;
+
+        std::memmove(location, old_location, size);
+        if(clear == true)
+        {
+            for(pool_size i = 0; i < size; i++)
+            {
+                // Don't erase bytes that were just moved into the overlapping part of the destination
+                if(old_location + i >= location && old_location + i < location + size)
+                    continue;
+
+                old_location[i] = static_cast<unsigned char>(0x0);
+            }
+        }
+    }
+
+    /**
+     * 
+     * @param queue Target queue
+     * @param offset Offset from the oldest byte in queue
+     * @return Index of the byte inside queue's memory block
+     */
+    static pool_size get_ring_index(const queue_type& queue, pool_size offset)
+    {
+        pool_size index = queue.Head + offset;
+
+        if(index >= queue.AllocatedSize)
+            index -= queue.AllocatedSize;
+
+        return index;
+    }
+
+    /**
+     * 
+     * @param queue Target queue
+     * @return Count of free bytes located right after the last byte of queue without crossing the end of memory block
+     */
+    static pool_size get_writable_size(const queue_type& queue)
+    {
+        if(queue.Head + queue.Size < queue.AllocatedSize)
+            return queue.AllocatedSize - queue.Head - queue.Size;
+
+        return queue.AllocatedSize - queue.Size;
+    }
+
+    /**
+     * Rotates queue contents inside its memory block so the oldest byte is located at the start of the block
+     * @param queue Target queue
+     */
+    void linearize_queue(queue_type* queue)
+    {
+        if(queue->Head == 0)
+            return;
+
+        unsigned char* block = get_storage(*queue);
+
+        if(queue->Head + queue->Size <= queue->AllocatedSize)
+            std::memmove(block, block + queue->Head, queue->Size);
+        else
+            std::rotate(block, block + queue->Head, block + queue->AllocatedSize);
+
+        queue->Head = 0;
+    }
+
+    /**
+     * Moves queue contents to a new memory block while keeping FIFO order of stored bytes
+     * @param queue Target queue
+     * @param location Pointer to the new memory block, can be equal to the current one when growing in place or overlap it when sliding back
+     * @param allocSize Size of the new memory block
+     */
+    void relocate_queue(queue_type* queue, unsigned char* location, pool_size allocSize)
+    {
+        unsigned char* old_location = get_block(*queue);
+        unsigned char* old_storage = get_storage(*queue);
+        pool_size old_size = queue->AllocatedSize;
+        bool wrapped = queue->Head + queue->Size > old_size;
+
+        if(location == old_location)
+        {
+            // Growing in place - wrapped part at the start of the block stays, part after Head is moved to the end of the block
+            if(wrapped && allocSize > old_size)
+            {
+                pool_size grown = allocSize - old_size;
+                std::memmove(location + queue->Head + grown, location + queue->Head, old_size - queue->Head);
+                queue->Head = to_descriptor_size(queue->Head + grown);
+            }
+            else if(queue->Head + queue->Size > allocSize)
+            {
+                linearize_queue(queue);
+            }
+        }
+        else if(old_storage == nullptr)
+        {
+            // Queue without memory block and inline storage holds no bytes
+            queue->Head = 0;
+        }
+        else if(old_location == nullptr || location + allocSize <= old_location || old_location + old_size <= location)
+        {
+            // Blocks don't overlap, both parts of the ring are copied straight to the start of the new block
+            pool_size first_part = wrapped ? old_size - queue->Head : queue->Size;
+            std::memcpy(location, old_storage + queue->Head, first_part);
+            std::memcpy(location + first_part, old_storage, queue->Size - first_part);
+
+            if(Config::clear_memory)
+                std::memset(old_storage, 0x0, old_size);
+
+            queue->Head = 0;
+        }
+        else
+        {
+            linearize_queue(queue);
+            relocate_bytes(old_location, location, queue->Size, Config::clear_memory);
+        }
+
+        if(location != old_location)
+        {
+            // Block that slides back into the gap before it overlaps the old one, so the old one has to be released first
+            bool overlapping = old_location != nullptr && location < old_location + old_size && old_location < location + allocSize;
+            if(overlapping)
+                allocator.release(get_offset(old_location), old_size);
+
+            // New block is claimed before the old one is released, released block could be merged with the new one otherwise
+            allocator.claim(get_offset(location), allocSize);
+            used_bytes += allocSize;
+
+            if(old_location != nullptr)
+            {
+                if(overlapping == false)
+                    allocator.release(get_offset(old_location), old_size);
+
+                used_bytes -= old_size;
+                unlink_queue(queue);
+            }
+
+            set_block(*queue, location);
+            queue->AllocatedSize = to_descriptor_size(allocSize);
+            link_queue(queue);
+        }
+        else
+        {
+            // Memory block was resized in place, only its end changes
+            allocator.resize(get_offset(location), old_size, allocSize);
+            used_bytes = used_bytes - old_size + allocSize;
+
+            queue->AllocatedSize = to_descriptor_size(allocSize);
+        }
+    }
+
+    /**
+     * 
+     * @param ptr pointer to allocated memory block, nullptr if queue starts in its inline storage
+     * @param allocSize size of allocated memory
+     * @returns ptr to object if byte was added, otherwise nullptr
+     */
+    queue_type* add_byte_queue(unsigned char* ptr, pool_size allocSize)
+    {
+        int queue_idx = take_free_descriptor();
+        if(queue_idx == -1)
+            return nullptr;
+
+        // Assign the memory to this queue
+        queue_type& queue = get_descriptor(queue_idx);
+        set_block(queue, ptr);
+        queue.AllocatedSize = to_descriptor_size(allocSize);
+        queue.Size = 0;
+        queue.Head = 0;
+        queue.PreviousQueue = -1;
+        queue.NextQueue = -1;
+        set_active(queue, true); // Mark as active
+        descriptor_chunks[queue_idx / DESCRIPTOR_CHUNK_SIZE]->ActiveMask |= 1ULL << (queue_idx % DESCRIPTOR_CHUNK_SIZE);
+        claim_slot(&queue, queue_idx);
+
+        if(ptr != nullptr)
+        {
+            allocator.claim(get_offset(ptr), allocSize);
+            used_bytes += allocSize;
+            link_queue(&queue);
+        }
+        return &queue;
+    }
+
+    /**
+     * Use only when creating new queue
+     * @param requested_size Requested allocation size
+     * @return Pointer to start of available memory block 
+     */
+    unsigned char* first_free_memory(pool_size requested_size)
+    {
+        pool_size offset = 0;
+
+        // Allocators round requested size up, size larger than arena could wrap around
+        if(requested_size > data.size())
+            return nullptr;
+
+        // Look for a gap that can fit the requested size
+        if(allocator.find(requested_size, offset))
+            return data.data() + offset;
+
+        // Reorganize memory until the requested size fits, free memory is checked again after each step
+        unsigned int finished_passes = 0;
+        while(organize_memory_step(finished_passes))
+        {
+            if(allocator.find(requested_size, offset))
+                return data.data() + offset;
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * Finds location for grown memory block of queue, block is grown in place or slid back before a new location is searched
+     * @param queue Target queue
+     * @param size Requested allocation size
+     * @return Pointer to start of memory block that can fit queue with requested size without reorganizing memory, nullptr if there is none
+     */
+    unsigned char* find_queue_location(const queue_type& queue, pool_size size)
+    {
+        if(size > data.size())
+            return nullptr;
+
+        unsigned char* block = get_block(queue);
+        if(block != nullptr)
+        {
+            // Check if gap between queue and next allocated queue is enough to use current ptr instead of relocating
+            // End of the block is compared as distance to the end of arena, so offset + size can't wrap around
+            pool_size block_offset = get_offset(block);
+            if(size <= data.size() - block_offset && allocator.can_resize(block_offset, queue.AllocatedSize, size))
+                return block;
+
+            // Gaps before and after the block together can fit the queue, its contents slide back by a short memmove
+            pool_size before = allocator.gap_before(block_offset);
+            if(before > 0 && size <= data.size() - (block_offset - before) &&
+               allocator.can_resize(block_offset - before, before + queue.AllocatedSize, size))
+                return block - before;
+        }
+
+        // Gap to the next queue isn't large enough, therefore the queue will be relocated to a gap that fits it
+        pool_size offset = 0;
+        if(allocator.find(size, offset) == false)
+            return nullptr;
+
+        return data.data() + offset;
+    }
+
+    /**
+     * Use only when reallocating already existing queue
+     * @param queue Target queue
+     * @param size Requested allocation size
+     * @return Pointer to start of available memory block 
+     */
+    unsigned char* get_available_memory_start(queue_type &queue, pool_size size)
+    {
+        unsigned char* memory_start = find_queue_location(queue, size);
+
+        // queue would exceed allocated size of arena, memory is reorganized until there's enough space to fit the queue
+        unsigned int finished_passes = 0;
+        while(memory_start == nullptr)
+        {
+            if(organize_memory_step(finished_passes) == false)
+                on_out_of_memory();
+
+            memory_start = find_queue_location(queue, size);
+        }
+    
+        return memory_start;
+    }
+
+    /**
+     * 
+     * @param queue Target queue
+     * @param count Count of added bytes
+     * @return Count of bytes queue has to fit once count bytes are added
+     * @exception on_out_of_memory is called if queue couldn't fit that many bytes even with whole arena
+     */
+    pool_size get_required_size(const queue_type& queue, pool_size count)
+    {
+        // Compared as difference, sum could wrap around for counts close to the limit of pool_size
+        if(count > data.size() - queue.Size)
+            on_out_of_memory();
+
+        return queue.Size + count;
+    }
+
+    /**
+     * Reorganizes memory for allocation that didn't fit, whole memory at once or Config::COMPACTION_STEP bytes by compact_step
+     * @param finished_passes Count of passes over whole memory done for the allocation, 0 before the first step
+     * @return true if allocation should be tried again, false if memory can't be organized any further
+     */
+    bool organize_memory_step(unsigned int& finished_passes)
+    {
+        if(Config::inline_compaction == false || placement_type::inline_compaction == false)
+            return false;
+
+        if(Config::COMPACTION_STEP == 0)
+        {
+            if(finished_passes > 0)
+                return false;
+
+            finished_passes++;
+            return try_organize_memory();
+        }
+
+        // Pass that started in the middle of arena didn't organize memory before it, therefore second pass is done as well
+        if(finished_passes == 2)
+            return false;
+
+        if(compact_step(Config::COMPACTION_STEP))
+            finished_passes++;
+
+        return true;
+    }
+
+    /**
+     * Moves whole memory block of queue back to free memory right before it, wrapped contents keep their Head offset
+     * Order of queues stays the same, so only location of queue changes
+     * @param queue Target queue
+     * @param location Start of free memory before the block, blocks can overlap
+     * @param next_location Item of queue_locations that follows the queue
+     */
+    void slide_queue(queue_type* queue, unsigned char* location, std::map<unsigned char*, int>::iterator next_location)
+    {
+        unsigned char* old_location = get_block(*queue);
+        relocate_bytes(old_location, location, queue->AllocatedSize, Config::clear_memory);
+
+        // Old block is released first as the blocks overlap when block moves by less than its size
+        allocator.release(get_offset(old_location), queue->AllocatedSize);
+        allocator.claim(get_offset(location), queue->AllocatedSize);
+
+        queue_locations.erase(old_location);
+        set_block(*queue, location);
+        queue_locations.emplace_hint(next_location, location, get_index(*queue));
+    }
+
+    /**
+     * 
+     * @param queue Target queue
+     * @param requested_size Size of memory block queue needs at least
+     * @return Size of memory block queue grows to based on queue_growth, never larger than arena
+     */
+    pool_size get_grown_size(const queue_type& queue, pool_size requested_size)
+    {
+        unsigned long long grownSize = queue_growth.get_grown_size(queue.AllocatedSize);
+
+        grownSize = std::min<unsigned long long>(grownSize, data.size());
+        return round_up_alloc_size(std::max(static_cast<pool_size>(grownSize), requested_size));
+    }
+
+    /**
+     * Grows queue's memory block once so it can fit requested count of bytes
+     * @param queue Target queue
+     * @param requested_size Count of bytes queue has to fit
+     * @exception on_out_of_memory is called if no memory space is available
+     */
+    void grow_queue(queue_type* queue, pool_size requested_size)
+    {
+        if(requested_size <= queue->AllocatedSize)
+            return;
+
+        pool_size minimalSize = round_up_alloc_size(requested_size);
+        pool_size newSize = get_grown_size(*queue, minimalSize);
+
+        // Larger block picked by growth policy isn't worth reorganizing memory, requested size is used if it doesn't fit
+        if(newSize > minimalSize && find_queue_location(*queue, newSize) == nullptr)
+            newSize = minimalSize;
+
+        // Memory may get reorganized while looking for space, queue's block is read only after that
+        unsigned char* newPosition = get_available_memory_start(*queue, newSize);
+        relocate_queue(queue, newPosition, newSize);
+    }
+
+    /**
+     * 
+     * @param queue Target queue
+     * @return Size of memory block queue shrinks to based on queue_shrink, current size if queue shouldn't shrink
+     */
+    pool_size get_shrunk_size(const queue_type& queue)
+    {
+        unsigned long long targetSize = queue_shrink.get_shrunk_size(queue.Size, queue.AllocatedSize);
+
+        targetSize = std::min<unsigned long long>(targetSize, queue.AllocatedSize);
+        return round_up_alloc_size(static_cast<pool_size>(targetSize));
+    }
+
+    /**
+     * Lowers allocation size of queue based on queue_shrink, memory is released in a single step
+     * @param queue Target queue
+     */
+    void shrink_queue(queue_type* queue)
+    {
+        // Queue without memory block has nothing to release
+        if(get_block(*queue) == nullptr)
+            return;
+
+        pool_size newSize = get_shrunk_size(*queue);
+        if(newSize >= queue->AllocatedSize)
+            return;
+
+        shrink_block(queue, newSize);
+    }
+
+    /**
+     * Shrinks memory block of queue in place, memory is released in a single step
+     * @param queue Target queue, it has to have memory block
+     * @param newSize New size of memory block rounded by allocator, smaller than current one and not smaller than Size of queue
+     */
+    void shrink_block(queue_type* queue, pool_size newSize)
+    {
+        // Bytes that fit inline storage are moved back to descriptor, so memory block is released completely
+        if(queue_type::INLINE_CAPACITY > 0 && queue->Size <= queue_type::INLINE_CAPACITY)
+        {
+            move_to_inline_storage(queue);
+            return;
+        }
+
+        // Empty queue releases its memory block completely, it gets a new one once a byte is enqueued
+        if(newSize == 0)
+        {
+            allocator.release(get_offset(get_block(*queue)), queue->AllocatedSize);
+            used_bytes -= queue->AllocatedSize;
+            unlink_queue(queue);
+            set_block(*queue, nullptr);
+            queue->AllocatedSize = 0;
+            organize_released_memory();
+            return;
+        }
+
+        // Allocator may hold whole block anyway, e.g. slot of slab, block keeps its size then so used memory stays accounted
+        if(allocator.can_resize(get_offset(get_block(*queue)), queue->AllocatedSize, newSize) == false)
+            return;
+
+        // Contents have to fit into the smaller block before it is shrunk
+        if(queue->Head + queue->Size > newSize)
+            linearize_queue(queue);
+
+        allocator.resize(get_offset(get_block(*queue)), queue->AllocatedSize, newSize);
+        used_bytes -= queue->AllocatedSize - newSize;
+        queue->AllocatedSize = newSize;
+        organize_released_memory();
+    }
+
+    /**
+     * Organizes memory while fragmentation left by released memory reaches Config::COMPACTION_THRESHOLD,
+     * so allocation rarely has to organize memory when its block doesn't fit
+     */
+    void organize_released_memory()
+    {
+        // Configuration without inline compaction leaves organizing memory to explicit calls, e.g. pool_compactor
+        if(Config::COMPACTION_THRESHOLD == 0 || Config::compaction == false || Config::inline_compaction == false ||
+           placement_type::supports_compaction == false || placement_type::inline_compaction == false)
+            return;
+
+        if(get_fragmentation() < Config::COMPACTION_THRESHOLD)
+            return;
+
+        // With limited step compaction is spread over following releases, each one moves at most the step
+        if(Config::COMPACTION_STEP == 0)
+            try_organize_memory();
+        else
+            compact_step(Config::COMPACTION_STEP);
+    }
+
+    /**
+     * Moves bytes of queue to its inline storage and releases its memory block
+     * @param queue Target queue, its bytes have to fit inline storage
+     */
+    void move_to_inline_storage(queue_type* queue)
+    {
+        unsigned char* block = get_block(*queue);
+        unsigned char* inline_bytes = const_cast<unsigned char*>(get_inline_bytes(*queue));
+        pool_size first_part = std::min<pool_size>(queue->Size, queue->AllocatedSize - queue->Head);
+
+        std::memcpy(inline_bytes, block + queue->Head, first_part);
+        std::memcpy(inline_bytes + first_part, block, queue->Size - first_part);
+
+        if(Config::clear_memory)
+            std::memset(block, 0x0, queue->AllocatedSize);
+
+        allocator.release(get_offset(block), queue->AllocatedSize);
+        used_bytes -= queue->AllocatedSize;
+        unlink_queue(queue);
+        set_block(*queue, nullptr);
+        queue->AllocatedSize = queue_type::INLINE_CAPACITY;
+        queue->Head = 0;
+        organize_released_memory();
+    }
+
+    /**
+     * 
+     * @param index Index of descriptor, has to be lower than descriptor_count
+     * @return Descriptor stored at index
+     */
+    queue_type& get_descriptor(unsigned int index)
+    {
+        return descriptor_chunks[index / DESCRIPTOR_CHUNK_SIZE]->Queues[index % DESCRIPTOR_CHUNK_SIZE];
+    }
+
+    /**
+     * Active descriptors are found through ActiveMask of chunks, so inactive descriptors are skipped 64 at once
+     * @param index Index of descriptor search starts at
+     * @return Index of the first active descriptor at index or after it, -1 if there is none
+     */
+    int find_active_descriptor(unsigned int index) const
+    {
+        unsigned int chunk_idx = index / DESCRIPTOR_CHUNK_SIZE;
+        if(chunk_idx >= descriptor_chunks.size())
+            return -1;
+
+        // Bits of descriptors before index are masked out in the first chunk
+        unsigned long long mask = descriptor_chunks[chunk_idx]->ActiveMask & (~0ULL << (index % DESCRIPTOR_CHUNK_SIZE));
+
+        while(mask == 0)
+        {
+            if(++chunk_idx >= descriptor_chunks.size())
+                return -1;
+
+            mask = descriptor_chunks[chunk_idx]->ActiveMask;
+        }
+
+        return static_cast<int>(chunk_idx * DESCRIPTOR_CHUNK_SIZE + count_trailing_zeros(mask));
+    }
+
+    /**
+     * 
+     * @param queue Active queue
+     * @return Index of queue's descriptor
+     */
+    int get_index(const queue_type& queue) const
+    {
+        return static_cast<int>(slots[queue.Slot].QueueIndex);
+    }
+
+    /**
+     * Takes the last released descriptor, a new descriptor is added to the table if none was released
+     * @return Index of inactive descriptor, -1 if max_queue_count queues are active
+     */
+    int take_free_descriptor()
+    {
+        if(free_queue_idx != -1)
+        {
+            int queue_idx = free_queue_idx;
+            free_queue_idx = get_descriptor(queue_idx).NextQueue;
+            return queue_idx;
+        }
+
+        if(max_queue_count != 0 && descriptor_count >= max_queue_count)
+            return -1;
+
+        // Descriptors are allocated in chunks, so pointers to existing descriptors stay valid when the table grows
+        if(descriptor_count % DESCRIPTOR_CHUNK_SIZE == 0)
+            descriptor_chunks.emplace_back(new descriptor_chunk());
+
+        return static_cast<int>(descriptor_count++);
+    }
+
+    /**
+     * Assigns the last released slot of handle table to queue, a new slot is added if none was released
+     * @param queue Target queue, it has to be active
+     * @param queue_idx Index of queue's descriptor
+     */
+    void claim_slot(queue_type* queue, int queue_idx)
+    {
+        if(free_slots.empty())
+        {
+            free_slots.push_back(static_cast<unsigned int>(slots.size()));
+            slots.emplace_back();
+        }
+
+        queue->Slot = free_slots.back();
+        free_slots.pop_back();
+
+        slots[queue->Slot].QueueIndex = static_cast<unsigned int>(queue_idx);
+    }
+
+    /**
+     * Releases slot of queue, handles that refer to it become stale
+     * @param queue Target queue
+     */
+    void release_slot(queue_type* queue)
+    {
+        slots[queue->Slot].QueueIndex = NO_QUEUE;
+        slots[queue->Slot].Generation++;
+        free_slots.push_back(queue->Slot);
+
+        queue->Slot = NO_QUEUE;
+    }
+
+    /**
+     * 
+     * @param handle Handle of queue
+     * @return Queue the handle refers to
+     * @exception on_illegal_operation is called if the handle is stale
+     */
+    queue_type* get_handle_queue(queue_handle handle)
+    {
+        queue_type* queue = resolve(handle);
+        if(queue == nullptr)
+            on_illegal_operation();
+
+        return queue;
+    }
+
+    enum : unsigned int { NO_QUEUE = 0xFFFFFFFF, DESCRIPTOR_CHUNK_SIZE = 64 };
+
+    typename Config::storage_type data;
+
+    typedef struct descriptor_chunk
+    {
+        // Bit i is set if Queues[i] is active, active queues are found and counted without reading descriptors
+        unsigned long long ActiveMask = 0;
+        queue_type Queues[DESCRIPTOR_CHUNK_SIZE];
+        
+    } descriptor_chunk;
+
+    // Descriptor table, grows by DESCRIPTOR_CHUNK_SIZE descriptors at once
+    std::vector<std::unique_ptr<descriptor_chunk>> descriptor_chunks;
+    unsigned int descriptor_count = 0;
+    unsigned int max_queue_count;
+
+    // Inactive descriptors are linked together through NextQueue, the last released one is reused first
+    int free_queue_idx = -1;
+
+    // Handle -> descriptor index, slots of destroyed queues are reused from free_slots
+    std::vector<queue_slot> slots;
+    std::vector<unsigned int> free_slots;
+
+    // Active queues holding a memory block are linked together in order of memory location through PreviousQueue / NextQueue
+    int first_queue_idx = -1;
+    int last_queue_idx = -1;
+
+    // Memory location -> queue index, used to find neighbours of a queue placed at new location
+    std::map<unsigned char*, int> queue_locations;
+
+    // Offset in arena where next compact_step continues
+    pool_size compaction_cursor = 0;
+
+    // Bytes of arena held by memory blocks, so fragmentation is known without walking queues
+    pool_size used_bytes = 0;
+
+    // Used by enqueue functions when queue runs out of allocated memory, set through set_queue_growth
+    typename Config::growth_type queue_growth;
+
+    // Used by dequeue functions when queue holds less bytes than its memory block can fit, set through set_queue_shrink
+    typename Config::shrink_type queue_shrink;
+
+    // Tracks which parts of arena are used by memory blocks of linked queues
+    placement_type allocator;
+};
+
+typedef basic_memory_pool<default_pool_config> memory_pool;
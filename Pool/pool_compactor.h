@@ -0,0 +1,171 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "memory_pool.h"
+
+typedef struct compaction_stats
+{
+    // Count of compact_step calls and count of them that reached the end of arena
+    unsigned long long StepCount = 0;
+    unsigned long long PassCount = 0;
+    // Time spent in compact_step, queue operations are blocked for all of it
+    unsigned long long TotalNanoseconds = 0;
+    unsigned long long LongestStepNanoseconds = 0;
+    
+} compaction_stats;
+
+/**
+ * Maintenance thread that organizes memory of a pool once its fragmentation reaches threshold, so queue operations don't have to.
+ * Pool should use configuration with inline_compaction set to false then
+ * 
+ * Pool isn't thread safe, so every thread that uses the pool has to hold mutex returned by get_mutex during queue operations.
+ * Compactor holds the mutex only during a single compact_step, so each stop of queue operations moves at most step budget bytes,
+ * or a single block that is larger than step budget.
+ * Descriptors of queues aren't moved by compaction, pointers to bytes of queues (peek, reserve) are valid only while the mutex is held
+ * 
+ * Allocation never waits for the compactor. Without inline compaction, block that doesn't fit only because memory is fragmented
+ * calls on_out_of_memory right away, even if the next pass would make room for it. Thread that can't wait for the next pass
+ * calls try_organize_memory / compact_step itself while it holds the mutex before such allocation, e.g. once get_fragmentation is high
+ */
+template<typename Pool>
+class pool_compactor
+{
+public:
+    /**
+     * 
+     * @param pool Compacted pool, it has to outlive the compactor
+     * @param threshold Fragmentation in percent at which compaction starts, see basic_memory_pool::get_fragmentation
+     * @param step_budget Count of bytes moved while the mutex is held, a single block is moved by each step if it is 0 or the block is larger
+     * @param interval Time between fragmentation checks, larger than 0
+     * @exception on_illegal_operation is called if interval isn't larger than 0
+     */
+    pool_compactor(Pool& pool, unsigned int threshold, pool_size step_budget, std::chrono::milliseconds interval)
+        : pool(pool), threshold(threshold), step_budget(step_budget), interval(interval)
+    {
+        // Maintenance thread would check fragmentation without any pause and keep a core busy
+        if(interval.count() <= 0)
+            on_illegal_operation();
+    }
+
+    ~pool_compactor()
+    {
+        stop();
+    }
+
+    pool_compactor(const pool_compactor&) = delete;
+    pool_compactor& operator=(const pool_compactor&) = delete;
+
+    /**
+     * Starts maintenance thread, nothing is done if it is running already
+     */
+    void start()
+    {
+        if(worker.joinable())
+            return;
+
+        stopping = false;
+        worker = std::thread(&pool_compactor::run, this);
+    }
+
+    /**
+     * Stops maintenance thread and waits until it finishes current step
+     */
+    void stop()
+    {
+        if(worker.joinable() == false)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    /**
+     * 
+     * @return Mutex that guards the pool
+     */
+    std::mutex& get_mutex()
+    {
+        return pool_mutex;
+    }
+
+    /**
+     * 
+     * @return Count of steps and time spent compacting so far
+     */
+    compaction_stats get_stats()
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        return stats;
+    }
+
+private:
+    Pool& pool;
+    unsigned int threshold;
+    pool_size step_budget;
+    std::chrono::milliseconds interval;
+
+    std::mutex pool_mutex;
+    compaction_stats stats;
+
+    std::thread worker;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::atomic<bool> stopping{false};
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        while(stopping == false)
+        {
+            wake.wait_for(lock, interval);
+            if(stopping)
+                break;
+
+            lock.unlock();
+            compact();
+            lock.lock();
+        }
+    }
+
+    /**
+     * Does steps of compaction until cursor of pool reaches the end of arena, mutex is released between steps
+     */
+    void compact()
+    {
+        bool finished = false;
+        bool checked = false;
+
+        while(finished == false && stopping == false)
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+
+            // Fragmentation is checked under the same lock as the first step
+            if(checked == false)
+            {
+                if(pool.get_fragmentation() < threshold)
+                    return;
+
+                checked = true;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            finished = pool.compact_step(step_budget);
+            unsigned long long elapsed = static_cast<unsigned long long>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+            stats.StepCount++;
+            stats.TotalNanoseconds += elapsed;
+            if(elapsed > stats.LongestStepNanoseconds)
+                stats.LongestStepNanoseconds = elapsed;
+            if(finished)
+                stats.PassCount++;
+        }
+    }
+};
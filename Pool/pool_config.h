@@ -0,0 +1,84 @@
+﻿#pragma once
+#include "../Allocator/bitmap_allocator.h"
+#include "../Allocator/buddy_allocator.h"
+#include "../Allocator/free_gap_index.h"
+#include "../Allocator/slab_allocator.h"
+#include "../Allocator/tlsf_allocator.h"
+#include "../Model/byte_queue.h"
+#include "../Model/capacity_policy.h"
+#include "../Model/compact_byte_queue.h"
+#include "../Model/inline_queue.h"
+#include "arena_storage.h"
+
+// Default arena fits 64 queues with default block size: 2048 / 64 = 32
+#define DEFAULT_ALLOC_SIZE  32
+#define MAX_QUEUE_COUNT     64
+#define MEMORY_ALLOC_SIZE   2048
+
+// Allocators that can be used for placement of memory blocks, selected allocator is set by POOL_ALLOCATOR
+// Every allocator provides reset, round_size, find, can_resize, gap_before, claim, release, resize and largest_gap
+// and declares whether memory can be organized (supports_compaction), whether allocation may do it (inline_compaction)
+// and whether it keeps state of every used block (tracks_blocks), so organized blocks have to be claimed one by one
+#define ALLOCATOR_FREE_GAP_INDEX    0
+#define ALLOCATOR_BITMAP            1
+#define ALLOCATOR_BUDDY             2
+#define ALLOCATOR_TLSF              3
+#define ALLOCATOR_SLAB              4
+
+#ifndef POOL_ALLOCATOR
+#define POOL_ALLOCATOR ALLOCATOR_FREE_GAP_INDEX
+#endif
+
+#if POOL_ALLOCATOR == ALLOCATOR_BITMAP
+typedef bitmap_allocator pool_allocator;
+#elif POOL_ALLOCATOR == ALLOCATOR_BUDDY
+typedef buddy_allocator pool_allocator;
+#elif POOL_ALLOCATOR == ALLOCATOR_TLSF
+typedef tlsf_allocator pool_allocator;
+#elif POOL_ALLOCATOR == ALLOCATOR_SLAB
+typedef slab_allocator pool_allocator;
+#else
+typedef free_gap_index pool_allocator;
+#endif
+
+// Arena larger than 4 GB is mapped from the system, so only pages used by queues take physical memory
+#if POOL_64BIT_SIZES
+typedef mapped_arena pool_arena;
+#else
+typedef heap_arena pool_arena;
+#endif
+
+/**
+ * Default configuration of basic_memory_pool. Custom configuration derives from it and hides members it changes,
+ * everything is resolved at compile time, so chosen policies are inlined into queue functions
+ */
+struct default_pool_config
+{
+    enum : unsigned int
+    {
+        GRANULE_SIZE = DEFAULT_ALLOC_SIZE,      // Size of the smallest memory block, new queue gets a block of this size
+        ARENA_SIZE = MEMORY_ALLOC_SIZE,         // Default size of arena, constructor of pool can override it
+        MAX_QUEUES = 0,                         // Default limit of active queues, 0 if count of queues is limited only by memory
+        COMPACTION_STEP = 0,                    // Bytes moved by one step of compaction when memory block doesn't fit, 0 if memory is organized at once
+        COMPACTION_THRESHOLD = 0                // Fragmentation in percent at which memory released by a queue is organized right away, 0 if never
+    };
+
+    // Memory is reorganized when memory block can't be placed otherwise, placement type has to support it as well
+    static const bool compaction = true;
+
+    // Allocation that doesn't fit reorganizes memory by itself if placement type allows it as well, otherwise it fails
+    // and memory is organized only by explicit try_organize_memory / compact_step calls, for example from pool_compactor.
+    // Failed allocation calls on_out_of_memory, it doesn't wait until pool_compactor organizes memory
+    static const bool inline_compaction = true;
+
+    // Bytes removed from queue and memory left by moved blocks are erased
+    static const bool clear_memory = true;
+
+    typedef pool_allocator placement_type;
+    // compact_byte_queue stores memory blocks as 32-bit offsets into arena and makes descriptors smaller,
+    // inline_queue keeps bytes of small queues inside descriptor instead of arena
+    typedef byte_queue descriptor_type;
+    typedef pool_arena storage_type;
+    typedef growth_policy growth_type;
+    typedef shrink_policy shrink_type;
+};